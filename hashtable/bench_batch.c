@@ -0,0 +1,98 @@
+/*
+ * Dávkové vyhledávání ht_get_batch proti smyčce volání ht_get.
+ *
+ * Vloží zadaný počet náhodných klíčů a poté je v náhodném pořadí vyhledá
+ * nejprve po jednom funkcí ht_get, pak po dávkách funkcí ht_get_batch.
+ * Výchozí počet klíčů je zvolen tak, aby tabulka i s klíči výrazně přesáhla
+ * poslední úroveň vyrovnávací paměti; jen tehdy má předčítání smysl.
+ * Implementace se volí při překladu, např. make bench_batch BACKEND=swiss.
+ *
+ * Použití: ./bench_batch [počet klíčů] [velikost dávky]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 22)
+#define BENCH_DEFAULT_BATCH 256
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+static double mops(int count, uint64_t ns) { return count * 1e3 / ns; }
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  int batch = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_BATCH;
+  if (count <= 0 || batch <= 0) {
+    fprintf(stderr, "usage: %s [key count] [batch size]\n", argv[0]);
+    return 1;
+  }
+  char **keys = bench_make_keys(count, BENCH_KEYS_RANDOM, 1);
+  char **shuffled = malloc(count * sizeof(char *));
+  float **values = malloc(batch * sizeof(float *));
+  if (keys == NULL || shuffled == NULL || values == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  uint64_t state = 3;
+  for (int i = 0; i < count; i++) {
+    shuffled[i] = keys[i];
+  }
+  for (int i = count - 1; i > 0; i--) {
+    int j = bench_random(&state) % (i + 1);
+    char *tmp = shuffled[i];
+    shuffled[i] = shuffled[j];
+    shuffled[j] = tmp;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+
+  float sum = 0;
+  int found = 0;
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    float *value = ht_get(&table, shuffled[i]);
+    if (value != NULL) {
+      sum += *value;
+      found++;
+    }
+  }
+  uint64_t single_ns = bench_now_ns() - start;
+
+  start = bench_now_ns();
+  for (int i = 0; i < count; i += batch) {
+    int n = count - i < batch ? count - i : batch;
+    ht_get_batch(&table, shuffled + i, n, values);
+    for (int j = 0; j < n; j++) {
+      if (values[j] != NULL) {
+        sum += *values[j];
+        found++;
+      }
+    }
+  }
+  uint64_t batch_ns = bench_now_ns() - start;
+  bench_sink = sum;
+
+  printf("%-8s %10s %8s %14s %14s %8s\n", "backend", "keys", "batch",
+         "get Mops/s", "batch Mops/s", "speedup");
+  printf("%-8s %10i %8i %14.2f %14.2f %8.2f\n", HT_BACKEND_NAME, count, batch,
+         mops(count, single_ns), mops(count, batch_ns),
+         (double)single_ns / batch_ns);
+  if (found != 2 * count) {
+    fprintf(stderr, "found %i of %i keys\n", found, 2 * count);
+    return 1;
+  }
+
+  ht_delete_all(&table);
+  free(values);
+  free(shuffled);
+  bench_free_keys(keys);
+  return 0;
+}
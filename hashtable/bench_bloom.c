@@ -0,0 +1,120 @@
+/*
+ * Bloomův filtr před seznamy synonym (HT_BLOOM) při hledání chybějících
+ * klíčů.
+ *
+ * Vloží zadaný počet náhodných klíčů do zřetězené tabulky s faktorem
+ * naplnění 1 a pak je v náhodném pořadí vyhledá funkcí ht_get; stejně tak
+ * stejný počet klíčů, které v tabulce nejsou. Pro tabulku bez volby
+ * a s volbou HT_BLOOM vypíše propustnost obou hledání a průměrný počet
+ * prvků prohlédnutých při hledání chybějícího klíče (podle počítadel
+ * ht_stats). Bez filtru je to průměrná délka seznamu, s filtrem jen
+ * seznamy klíčů, které filtr chybně propustil.
+ *
+ * Použití: ./bench_bloom [počet klíčů]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(HT_CHAINED) || !defined(HT_STATS)
+#error "bench_bloom requires BACKEND=chained and STATS=1"
+#endif
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+static double mops(int count, uint64_t ns) { return count * 1e3 / ns; }
+
+/*
+ * Vyhledá klíče keys[order[0]] až keys[order[count - 1]]. Do *ns zapíše dobu
+ * hledání a do *probes počet prohlédnutých prvků; vrací počet nalezených
+ * klíčů.
+ */
+static int bench_lookups(ht_table_t *table, char **keys, const int *order,
+                         int count, uint64_t *ns, uint64_t *probes) {
+  ht_stats_t before;
+  ht_stats_t after;
+  ht_stats(table, &before);
+  float sum = 0;
+  int found = 0;
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    float *value = ht_get(table, keys[order[i]]);
+    if (value != NULL) {
+      sum += *value;
+      found++;
+    }
+  }
+  *ns = bench_now_ns() - start;
+  bench_sink = sum;
+  ht_stats(table, &after);
+  *probes = after.counters.probes - before.counters.probes;
+  return found;
+}
+
+/*
+ * Naplní tabulku s volbami flags, vyhledá přítomné i chybějící klíče
+ * a vypíše řádek výsledků. Vrací počet nalezených klíčů.
+ */
+static int bench_run(const char *name, unsigned flags, char **keys,
+                     const int *order, int count) {
+  ht_table_t table;
+  ht_init_flags(&table, count, flags);
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+
+  uint64_t hit_ns;
+  uint64_t miss_ns;
+  uint64_t probes;
+  int found = bench_lookups(&table, keys, order, count, &hit_ns, &probes);
+  found += bench_lookups(&table, keys + count, order, count, &miss_ns,
+                         &probes);
+  printf("%-8s %10i %8.2f %14.2f %14.2f %14.3f\n", name, count,
+         ht_load_factor(&table), mops(count, hit_ns), mops(count, miss_ns),
+         (double)probes / count);
+  ht_delete_all(&table);
+  return found;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [key count]\n", argv[0]);
+    return 1;
+  }
+  // první polovina klíčů se vloží, druhá slouží k neúspěšnému hledání
+  char **keys = bench_make_keys(2 * count, BENCH_KEYS_RANDOM, 1);
+  int *order = malloc(count * sizeof(int));
+  if (keys == NULL || order == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  uint64_t state = 3;
+  for (int i = 0; i < count; i++) {
+    order[i] = i;
+  }
+  for (int i = count - 1; i > 0; i--) {
+    int j = bench_random(&state) % (i + 1);
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  printf("%-8s %10s %8s %14s %14s %14s\n", "mode", "keys", "load",
+         "hit Mops/s", "miss Mops/s", "steps/miss");
+  int found = bench_run("plain", 0, keys, order, count);
+  found += bench_run("bloom", HT_BLOOM, keys, order, count);
+
+  free(order);
+  bench_free_keys(keys);
+  if (found != 2 * count) {
+    fprintf(stderr, "found %i of %i keys\n", found, 2 * count);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * Škálování souběžné tabulky (ht_concurrent.c) s počtem vláken.
+ *
+ * Vloží zadaný počet náhodných klíčů a pak je 1, 2, 4, ... vláken současně
+ * náhodně čte funkcí ht_read a každou desátou operací přepisuje funkcí
+ * ht_insert. Každý počet vláken se měří dvakrát: jednou se všemi voláními
+ * pod jediným společným zámkem, jak se tabulka bez zámků používala dosud,
+ * a jednou bez něj, kdy čtení nebere žádné zámky a zápisy jen zámky
+ * svých řádků.
+ *
+ * Použití: ./bench_concurrent [počet klíčů] [nejvyšší počet vláken]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifndef HT_CONCURRENT
+#error "bench_concurrent requires BACKEND=concurrent"
+#endif
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_OPS_PER_THREAD (1 << 21)
+#define BENCH_WRITE_EVERY 10
+
+typedef struct bench_thread {
+  pthread_t thread;
+  ht_table_t *table;
+  char **keys;
+  int count;
+  uint64_t seed;
+  pthread_mutex_t *global; // společný zámek všech volání, nebo NULL
+  int found;
+  float sum; // součet přečtených hodnot pro bench_sink
+} bench_thread_t;
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+static void *bench_worker(void *arg) {
+  bench_thread_t *self = arg;
+  uint64_t state = self->seed;
+  float sum = 0;
+  // počítá se lokálně, struktury vláken sdílejí řádky vyrovnávací paměti
+  int found = 0;
+  for (int i = 0; i < BENCH_OPS_PER_THREAD; i++) {
+    char *key = self->keys[bench_random(&state) % self->count];
+    float value;
+    if (self->global != NULL) {
+      pthread_mutex_lock(self->global);
+    }
+    if (i % BENCH_WRITE_EVERY == 0) {
+      ht_insert(self->table, key, i);
+      found++;
+    } else if (ht_read(self->table, key, &value)) {
+      sum += value;
+      found++;
+    }
+    if (self->global != NULL) {
+      pthread_mutex_unlock(self->global);
+    }
+  }
+  self->found = found;
+  self->sum = sum;
+  return NULL;
+}
+
+/*
+ * Spustí threads vláken nad tabulkou a vrátí propustnost v milionech
+ * operací za sekundu, nebo zápornou hodnotu, pokud některé čtení klíč
+ * nenašlo.
+ */
+static double bench_run(ht_table_t *table, char **keys, int count,
+                        int threads, pthread_mutex_t *global) {
+  bench_thread_t *workers = malloc(threads * sizeof(bench_thread_t));
+  if (workers == NULL) {
+    return -1;
+  }
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < threads; i++) {
+    workers[i] = (bench_thread_t){.table = table,
+                                  .keys = keys,
+                                  .count = count,
+                                  .seed = 7 + i,
+                                  .global = global,
+                                  .found = 0};
+    pthread_create(&workers[i].thread, NULL, bench_worker, &workers[i]);
+  }
+  int found = 0;
+  float sum = 0;
+  for (int i = 0; i < threads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    found += workers[i].found;
+    sum += workers[i].sum;
+  }
+  bench_sink = sum;
+  uint64_t ns = bench_now_ns() - start;
+  free(workers);
+  if (found != threads * BENCH_OPS_PER_THREAD) {
+    return -1;
+  }
+  return (double)threads * BENCH_OPS_PER_THREAD * 1e3 / ns;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  int max_threads = argc > 2 ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (count <= 0 || max_threads <= 0) {
+    fprintf(stderr, "usage: %s [key count] [max threads]\n", argv[0]);
+    return 1;
+  }
+  char **keys = bench_make_keys(count, BENCH_KEYS_RANDOM, 1);
+  if (keys == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+  pthread_mutex_t global;
+  pthread_mutex_init(&global, NULL);
+
+  printf("%-8s %10s %14s %14s %10s\n", "threads", "keys", "mutex Mops/s",
+         "table Mops/s", "scaling");
+  double single = 0;
+  for (int threads = 1;; threads *= 2) {
+    if (threads > max_threads) {
+      threads = max_threads;
+    }
+    double mutex = bench_run(&table, keys, count, threads, &global);
+    double lockfree = bench_run(&table, keys, count, threads, NULL);
+    if (mutex < 0 || lockfree < 0) {
+      fprintf(stderr, "lookup failed with %i threads\n", threads);
+      return 1;
+    }
+    if (threads == 1) {
+      single = lockfree;
+    }
+    printf("%-8i %10i %14.2f %14.2f %10.2f\n", threads, count, mutex, lockfree,
+           lockfree / single);
+    if (threads == max_threads) {
+      break;
+    }
+  }
+
+  pthread_mutex_destroy(&global);
+  ht_delete_all(&table);
+  bench_free_keys(keys);
+  return 0;
+}
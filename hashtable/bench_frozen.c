@@ -0,0 +1,145 @@
+/*
+ * Zmrazení tabulky a hledání ve zmrazené tabulce.
+ *
+ * Vloží zadaný počet náhodných klíčů do tabulky zvolené implementace,
+ * zmrazí ji funkcí ht_freeze a v náhodném pořadí vyhledá všechny klíče
+ * funkcemi ht_get a ht_frozen_get; stejně tak stejný počet klíčů, které
+ * v tabulce nejsou. Zmrazenou tabulku pak zapíše do souboru a načte zpět.
+ * Pro srovnání s načtením změří kopii stejně velkého bloku funkcí memcpy
+ * do nově alokované paměti; soubor je při načítání obvykle ve vyrovnávací
+ * paměti systému. Implementace se volí při překladu, např.
+ * make bench_frozen BACKEND=swiss.
+ *
+ * Použití: ./bench_frozen [počet klíčů]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include "ht_frozen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_FILE "bench_frozen.bin"
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+static double mops(int count, uint64_t ns) { return count * 1e3 / ns; }
+
+/*
+ * Vyhledá klíče keys[order[0]] až keys[order[count - 1]] v tabulce table,
+ * nebo ve zmrazené tabulce frozen, pokud není NULL. Do *found přičte počet
+ * nalezených klíčů a vrací dobu hledání v nanosekundách.
+ */
+static uint64_t bench_lookups(ht_table_t *table, ht_frozen_t *frozen,
+                              char **keys, const int *order, int count,
+                              int *found) {
+  float sum = 0;
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    float *value = frozen != NULL ? ht_frozen_get(frozen, keys[order[i]])
+                                  : ht_get(table, keys[order[i]]);
+    if (value != NULL) {
+      sum += *value;
+      (*found)++;
+    }
+  }
+  uint64_t ns = bench_now_ns() - start;
+  bench_sink = sum;
+  return ns;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [key count]\n", argv[0]);
+    return 1;
+  }
+  // první polovina klíčů se vloží, druhá slouží k neúspěšnému hledání
+  char **keys = bench_make_keys(2 * count, BENCH_KEYS_RANDOM, 1);
+  int *order = malloc(count * sizeof(int));
+  if (keys == NULL || order == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  uint64_t state = 3;
+  for (int i = 0; i < count; i++) {
+    order[i] = i;
+  }
+  for (int i = count - 1; i > 0; i--) {
+    int j = bench_random(&state) % (i + 1);
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+  ht_frozen_t frozen;
+  uint64_t start = bench_now_ns();
+  if (!ht_freeze(&table, &frozen)) {
+    fprintf(stderr, "freeze failed\n");
+    return 1;
+  }
+  uint64_t freeze_ns = bench_now_ns() - start;
+
+  int table_found = 0;
+  int frozen_found = 0;
+  uint64_t table_hit_ns =
+      bench_lookups(&table, NULL, keys, order, count, &table_found);
+  uint64_t table_miss_ns =
+      bench_lookups(&table, NULL, keys + count, order, count, &table_found);
+  uint64_t frozen_hit_ns =
+      bench_lookups(NULL, &frozen, keys, order, count, &frozen_found);
+  uint64_t frozen_miss_ns =
+      bench_lookups(NULL, &frozen, keys + count, order, count, &frozen_found);
+
+  ht_frozen_t loaded;
+  if (!ht_frozen_save(&frozen, BENCH_FILE)) {
+    fprintf(stderr, "cannot write %s\n", BENCH_FILE);
+    return 1;
+  }
+  start = bench_now_ns();
+  bool load_ok = ht_frozen_load(&loaded, BENCH_FILE);
+  uint64_t load_ns = bench_now_ns() - start;
+  remove(BENCH_FILE);
+  start = bench_now_ns();
+  char *copy = malloc(frozen.data_size);
+  if (copy != NULL) {
+    memcpy(copy, frozen.data, frozen.data_size);
+  }
+  uint64_t copy_ns = bench_now_ns() - start;
+  bench_sink = copy != NULL ? copy[frozen.data_size - 1] : 0;
+  int loaded_found = 0;
+  if (load_ok) {
+    bench_lookups(NULL, &loaded, keys, order, count, &loaded_found);
+  }
+
+  printf("%-8s %10s %10s %8s %12s %12s %12s %12s %9s %9s\n", "backend",
+         "keys", "freeze ms", "MiB", "hit Mops/s", "frozen hit",
+         "miss Mops/s", "frozen miss", "load ms", "memcpy ms");
+  printf("%-8s %10i %10.2f %8.2f %12.2f %12.2f %12.2f %12.2f %9.2f %9.2f\n",
+         HT_BACKEND_NAME, count, freeze_ns / 1e6,
+         frozen.data_size / (1024.0 * 1024.0), mops(count, table_hit_ns),
+         mops(count, frozen_hit_ns), mops(count, table_miss_ns),
+         mops(count, frozen_miss_ns), load_ns / 1e6, copy_ns / 1e6);
+
+  free(copy);
+  ht_frozen_free(&loaded);
+  ht_frozen_free(&frozen);
+  ht_delete_all(&table);
+  free(order);
+  bench_free_keys(keys);
+  if (table_found != count || frozen_found != count ||
+      loaded_found != count) {
+    fprintf(stderr, "found %i, %i frozen and %i loaded of %i keys\n",
+            table_found, frozen_found, loaded_found, count);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Tabulka s celočíselnými klíči z HTDEC/HTDEF proti převodu klíčů na řetězce.
+ *
+ * Vloží zadaný počet náhodných 64bitových identifikátorů do tabulky
+ * ht_u64_t a stejné identifikátory převedené funkcí snprintf na řetězce do
+ * tabulky zvolené implementace; to je dosavadní způsob ukládání číselných
+ * klíčů. Pak všechny klíče v náhodném pořadí vyhledá a vypíše propustnost
+ * vkládání i hledání. U řetězcové tabulky se převod klíče měří při každém
+ * hledání, protože volající má v ruce číslo. Implementace řetězcové tabulky
+ * se volí při překladu, např. make bench_generic BACKEND=swiss.
+ *
+ * Použití: ./bench_generic [počet klíčů]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include "ht_generic.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+
+// Dost místa pro desítkový zápis libovolného uint64_t
+#define BENCH_KEY_SIZE 24
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile double bench_sink;
+
+static double mops(int count, uint64_t ns) { return count * 1e3 / ns; }
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [key count]\n", argv[0]);
+    return 1;
+  }
+  uint64_t *ids = malloc(count * sizeof(uint64_t));
+  int *order = malloc(count * sizeof(int));
+  // tabulka si klíče nekopíruje, každý vložený klíč má proto vlastní místo
+  char *strings = malloc((size_t)count * BENCH_KEY_SIZE);
+  if (ids == NULL || order == NULL || strings == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  uint64_t state = 3;
+  for (int i = 0; i < count; i++) {
+    ids[i] = bench_random(&state);
+    order[i] = i;
+  }
+  for (int i = count - 1; i > 0; i--) {
+    int j = bench_random(&state) % (i + 1);
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    char *string = strings + (size_t)i * BENCH_KEY_SIZE;
+    snprintf(string, BENCH_KEY_SIZE, "%" PRIu64, ids[i]);
+    ht_insert(&table, string, i);
+  }
+  uint64_t string_insert_ns = bench_now_ns() - start;
+
+  ht_u64_t generic;
+  ht_u64_init(&generic);
+  start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    ht_u64_insert(&generic, ids[i], i);
+  }
+  uint64_t generic_insert_ns = bench_now_ns() - start;
+
+  char key[BENCH_KEY_SIZE];
+  int string_found = 0;
+  double sum = 0;
+  start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    snprintf(key, sizeof(key), "%" PRIu64, ids[order[i]]);
+    float *value = ht_get(&table, key);
+    if (value != NULL) {
+      sum += *value;
+      string_found++;
+    }
+  }
+  uint64_t string_get_ns = bench_now_ns() - start;
+
+  int generic_found = 0;
+  start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    double *value = ht_u64_get(&generic, ids[order[i]]);
+    if (value != NULL) {
+      sum += *value;
+      generic_found++;
+    }
+  }
+  uint64_t generic_get_ns = bench_now_ns() - start;
+  bench_sink = sum;
+
+  printf("%-10s %10s %15s %15s\n", "table", "keys", "insert Mops/s",
+         "get Mops/s");
+  printf("%-10s %10i %15.2f %15.2f\n", HT_BACKEND_NAME, count,
+         mops(count, string_insert_ns), mops(count, string_get_ns));
+  printf("%-10s %10i %15.2f %15.2f\n", "ht_u64", count,
+         mops(count, generic_insert_ns), mops(count, generic_get_ns));
+
+  ht_u64_delete_all(&generic);
+  ht_delete_all(&table);
+  free(strings);
+  free(order);
+  free(ids);
+  if (string_found != count || generic_found != count) {
+    fprintf(stderr, "found %i and %i generic of %i keys\n", string_found,
+            generic_found, count);
+    return 1;
+  }
+  return 0;
+}
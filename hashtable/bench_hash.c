@@ -0,0 +1,119 @@
+/*
+ * Porovnání rozptylovacích funkcí: původní součet znaků klíče a get_hash.
+ *
+ * Pro každou sadu klíčů vypíše průměrnou dobu výpočtu jedné hodnoty a
+ * rozdělení délek seznamů synonym (podíl řádků s 0, 1, ... prvky) při
+ * faktoru naplnění 1. Pro srovnání je uvedeno i ideální (Poissonovo)
+ * rozdělení.
+ *
+ * Použití: ./bench_hash [počet klíčů]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_ROUNDS 5
+#define BENCH_MAX_CHAIN 8
+
+typedef uint64_t (*hash_function_t)(char *key, uint64_t seed);
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile uint64_t bench_sink;
+
+/*
+ * Původní rozptylovací funkce tabulky.
+ */
+static uint64_t sum_hash(char *key, uint64_t seed) {
+  (void)seed;
+  unsigned int result = 1;
+  int length = strlen(key);
+  for (int i = 0; i < length; i++) {
+    result += key[i];
+  }
+  return result;
+}
+
+static void print_histogram(const char *name, double ns, int max,
+                            const double share[]) {
+  printf("%-10s %8.2f %6i", name, ns, max);
+  for (int i = 0; i <= BENCH_MAX_CHAIN; i++) {
+    printf(" %6.2f%%", 100 * share[i]);
+  }
+  printf("\n");
+}
+
+static void bench_function(const char *name, hash_function_t hash, char **keys,
+                           int count) {
+  uint64_t seed = 0x5EED;
+  int *lengths = calloc(count, sizeof(int));
+  if (lengths == NULL) {
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    lengths[hash(keys[i], seed) % count]++;
+  }
+  double share[BENCH_MAX_CHAIN + 1] = {0};
+  int max = 0;
+  for (int i = 0; i < count; i++) {
+    int length = lengths[i] < BENCH_MAX_CHAIN ? lengths[i] : BENCH_MAX_CHAIN;
+    share[length] += 1.0 / count;
+    if (lengths[i] > max) {
+      max = lengths[i];
+    }
+  }
+  free(lengths);
+
+  uint64_t sink = 0;
+  uint64_t start = bench_now_ns();
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (int i = 0; i < count; i++) {
+      sink += hash(keys[i], seed + round);
+    }
+  }
+  double ns = (double)(bench_now_ns() - start) / BENCH_ROUNDS / count;
+  bench_sink = sink;
+  print_histogram(name, ns, max, share);
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [key count]\n", argv[0]);
+    return 1;
+  }
+
+  double ideal[BENCH_MAX_CHAIN + 1];
+  double factorial = 1;
+  ideal[BENCH_MAX_CHAIN] = 1;
+  for (int i = 0; i < BENCH_MAX_CHAIN; i++) {
+    factorial *= i > 0 ? i : 1;
+    ideal[i] = exp(-1) / factorial;
+    ideal[BENCH_MAX_CHAIN] -= ideal[i];
+  }
+
+  for (int kind = BENCH_KEYS_SEQUENTIAL; kind <= BENCH_KEYS_RANDOM; kind++) {
+    char **keys = bench_make_keys(count, kind, kind + 1);
+    if (keys == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+    }
+    printf("keys: %s (%i), buckets: %i\n", BENCH_KEY_KIND_NAMES[kind], count,
+           count);
+    printf("%-10s %8s %6s", "function", "ns/hash", "max");
+    for (int i = 0; i < BENCH_MAX_CHAIN; i++) {
+      printf(" %7i", i);
+    }
+    printf(" %6i+\n", BENCH_MAX_CHAIN);
+    bench_function("sum", sum_hash, keys, count);
+    bench_function("get_hash", get_hash, keys, count);
+    print_histogram("ideal", 0, 0, ideal);
+    printf("\n");
+    bench_free_keys(keys);
+  }
+  return 0;
+}
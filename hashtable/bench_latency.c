@@ -0,0 +1,89 @@
+/*
+ * Rozdělení doby jednotlivých vyhledání zvolené implementace tabulky.
+ *
+ * Vloží zadaný počet náhodných klíčů a pak každé vyhledání funkcí ht_get
+ * změří zvlášť, jednou pro klíče v tabulce a jednou pro klíče, které v ní
+ * nejsou. Vypíše medián a horní percentily v nanosekundách; časy zahrnují
+ * i režii čtení hodin, která je pro všechny implementace stejná.
+ * Implementace se volí při překladu, např. make bench_latency BACKEND=cuckoo.
+ *
+ * Použití: ./bench_latency [počet klíčů]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_LOOKUPS (1 << 22)
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+/*
+ * Změří BENCH_LOOKUPS vyhledání náhodně vybraných klíčů z keys[0] až
+ * keys[count - 1] a vypíše řádek s percentily. Vrací počet nalezených klíčů.
+ */
+static int bench_run(ht_table_t *table, char **keys, int count,
+                     const char *kind, uint32_t latencies[]) {
+  uint64_t state = 11;
+  float sum = 0;
+  int found = 0;
+  for (int i = 0; i < BENCH_LOOKUPS; i++) {
+    char *key = keys[bench_random(&state) % count];
+    uint64_t start = bench_now_ns();
+    float *value = ht_get(table, key);
+    latencies[i] = bench_now_ns() - start;
+    if (value != NULL) {
+      sum += *value;
+      found++;
+    }
+  }
+  bench_sink = sum;
+  bench_sort_latencies(latencies, BENCH_LOOKUPS);
+  printf("%-8s %10i %6s %8u %8u %8u %8u %8u\n", HT_BACKEND_NAME, count, kind,
+         bench_percentile(latencies, BENCH_LOOKUPS, 0.5),
+         bench_percentile(latencies, BENCH_LOOKUPS, 0.99),
+         bench_percentile(latencies, BENCH_LOOKUPS, 0.999),
+         bench_percentile(latencies, BENCH_LOOKUPS, 0.9999),
+         latencies[BENCH_LOOKUPS - 1]);
+  return found;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [key count]\n", argv[0]);
+    return 1;
+  }
+  // první polovina klíčů se vloží, druhá slouží k neúspěšnému hledání
+  char **keys = bench_make_keys(2 * count, BENCH_KEYS_RANDOM, 1);
+  uint32_t *latencies = malloc(BENCH_LOOKUPS * sizeof(uint32_t));
+  if (keys == NULL || latencies == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+
+  printf("%-8s %10s %6s %8s %8s %8s %8s %8s\n", "backend", "keys", "kind",
+         "p50 ns", "p99", "p99.9", "p99.99", "max");
+  int hits = bench_run(&table, keys, count, "hit", latencies);
+  int misses = bench_run(&table, keys + count, count, "miss", latencies);
+  ht_stats_print(&table, stderr);
+
+  ht_delete_all(&table);
+  free(latencies);
+  bench_free_keys(keys);
+  if (hits != BENCH_LOOKUPS || misses != 0) {
+    fprintf(stderr, "found %i of %i keys, %i missing keys\n", hits,
+            BENCH_LOOKUPS, misses);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Propustnost vkládání a vyhledávání zvolené implementace tabulky.
+ *
+ * Vloží zadaný počet náhodných klíčů a poté je v náhodném pořadí vyhledá
+ * funkcí ht_get; stejně tak vyhledá stejný počet klíčů, které v tabulce
+ * nejsou. Pro srovnání s postupným vkládáním sestaví z týchž klíčů druhou
+ * tabulku funkcí ht_insert_bulk. Stav tabulky po vyhledávání vypíše funkcí
+ * ht_stats_print na standardní chybový výstup (s počítadly při STATS=1).
+ * Implementace se volí při překladu, např. make bench_lookup BACKEND=swiss.
+ *
+ * Použití: ./bench_lookup [počet klíčů]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+static double mops(int count, uint64_t ns) { return count * 1e3 / ns; }
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [key count]\n", argv[0]);
+    return 1;
+  }
+  // první polovina klíčů se vloží, druhá slouží k neúspěšnému hledání
+  char **keys = bench_make_keys(2 * count, BENCH_KEYS_RANDOM, 1);
+  int *order = malloc(count * sizeof(int));
+  ht_item_t *items = malloc(count * sizeof(ht_item_t));
+  if (keys == NULL || order == NULL || items == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  uint64_t state = 3;
+  for (int i = 0; i < count; i++) {
+    order[i] = i;
+  }
+  for (int i = count - 1; i > 0; i--) {
+    int j = bench_random(&state) % (i + 1);
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+  uint64_t insert_ns = bench_now_ns() - start;
+
+  float sum = 0;
+  int found = 0;
+  start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    float *value = ht_get(&table, keys[order[i]]);
+    if (value != NULL) {
+      sum += *value;
+      found++;
+    }
+  }
+  uint64_t hit_ns = bench_now_ns() - start;
+
+  start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    float *value = ht_get(&table, keys[count + order[i]]);
+    if (value != NULL) {
+      sum += *value;
+      found++;
+    }
+  }
+  uint64_t miss_ns = bench_now_ns() - start;
+  bench_sink = sum;
+  ht_stats_print(&table, stderr);
+
+  start = bench_now_ns();
+  ht_delete_all(&table);
+  uint64_t clear_ns = bench_now_ns() - start;
+
+  for (int i = 0; i < count; i++) {
+    items[i].key = keys[i];
+    items[i].value = i;
+  }
+  start = bench_now_ns();
+  ht_insert_bulk(&table, items, count);
+  uint64_t bulk_ns = bench_now_ns() - start;
+  ht_delete_all(&table);
+
+  printf("%-8s %10s %14s %14s %14s %14s %10s\n", "backend", "keys",
+         "insert Mops/s", "bulk Mops/s", "hit Mops/s", "miss Mops/s",
+         "clear ms");
+  printf("%-8s %10i %14.2f %14.2f %14.2f %14.2f %10.2f\n", HT_BACKEND_NAME,
+         count, mops(count, insert_ns), mops(count, bulk_ns),
+         mops(count, hit_ns), mops(count, miss_ns), clear_ns / 1e6);
+  if (found != count) {
+    fprintf(stderr, "found %i of %i keys\n", found, count);
+    return 1;
+  }
+
+  free(items);
+  free(order);
+  bench_free_keys(keys);
+  return 0;
+}
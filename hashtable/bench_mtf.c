@@ -0,0 +1,134 @@
+/*
+ * Přesouvání nalezených prvků na začátek seznamu synonym (HT_MOVE_TO_FRONT)
+ * při Zipfově rozdělení hledaných klíčů.
+ *
+ * Vloží zadaný počet náhodných klíčů do zřetězené tabulky s faktorem
+ * naplnění 1, nejčastěji hledané klíče jako první, takže bez přesouvání
+ * leží na konci svých seznamů. Pak klíče vyhledá funkcí ht_get v pořadí
+ * vybraném podle Zipfova rozdělení: k-tý nejčastější klíč s pravděpodobností
+ * úměrnou 1 / k^s. Pro tabulku bez volby a s volbou HT_MOVE_TO_FRONT vypíše
+ * průměrný počet prvků prohlédnutých při jednom hledání (podle počítadel
+ * ht_stats) a propustnost.
+ *
+ * Použití: ./bench_mtf [počet klíčů] [exponent s]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(HT_CHAINED) || !defined(HT_STATS)
+#error "bench_mtf requires BACKEND=chained and STATS=1"
+#endif
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_DEFAULT_EXPONENT 1.0
+#define BENCH_LOOKUPS (1 << 22)
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+/*
+ * Vybere lookups indexů klíčů z <0, count) podle Zipfova rozdělení
+ * s exponentem exponent; index 0 je nejčastější. Vrací NULL, pokud se
+ * nepodařilo alokovat paměť.
+ */
+static int *bench_zipf(int count, int lookups, double exponent,
+                       uint64_t seed) {
+  double *cdf = malloc(count * sizeof(double));
+  int *ranks = malloc(lookups * sizeof(int));
+  if (cdf == NULL || ranks == NULL) {
+    free(cdf);
+    free(ranks);
+    return NULL;
+  }
+  double sum = 0;
+  for (int k = 0; k < count; k++) {
+    sum += 1 / pow(k + 1, exponent);
+    cdf[k] = sum;
+  }
+  for (int i = 0; i < lookups; i++) {
+    double u = (bench_random(&seed) >> 11) * 0x1p-53 * sum;
+    int low = 0;
+    int high = count - 1;
+    while (low < high) {
+      int middle = low + (high - low) / 2;
+      if (cdf[middle] <= u) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    ranks[i] = low;
+  }
+  free(cdf);
+  return ranks;
+}
+
+/*
+ * Naplní tabulku s volbami flags, vyhledá klíče s indexy ranks a vypíše
+ * řádek výsledků. Vrací počet nalezených klíčů.
+ */
+static int bench_run(const char *name, unsigned flags, char **keys, int count,
+                     double exponent, const int *ranks) {
+  ht_table_t table;
+  ht_init_flags(&table, count, flags);
+  for (int i = 0; i < count; i++) {
+    ht_insert(&table, keys[i], i);
+  }
+
+  ht_stats_t before;
+  ht_stats_t after;
+  ht_stats(&table, &before);
+  float sum = 0;
+  int found = 0;
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < BENCH_LOOKUPS; i++) {
+    float *value = ht_get(&table, keys[ranks[i]]);
+    if (value != NULL) {
+      sum += *value;
+      found++;
+    }
+  }
+  uint64_t ns = bench_now_ns() - start;
+  bench_sink = sum;
+  ht_stats(&table, &after);
+
+  double steps = (double)(after.counters.probes - before.counters.probes) /
+                 (after.counters.lookups - before.counters.lookups);
+  printf("%-14s %10i %8.2f %8.2f %14.3f %14.2f\n", name, count, exponent,
+         after.load_factor, steps, BENCH_LOOKUPS * 1e3 / ns);
+  ht_delete_all(&table);
+  return found;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  double exponent = argc > 2 ? atof(argv[2]) : BENCH_DEFAULT_EXPONENT;
+  if (count <= 0 || exponent < 0) {
+    fprintf(stderr, "usage: %s [key count] [zipf exponent]\n", argv[0]);
+    return 1;
+  }
+  char **keys = bench_make_keys(count, BENCH_KEYS_RANDOM, 1);
+  int *ranks = bench_zipf(count, BENCH_LOOKUPS, exponent, 5);
+  if (keys == NULL || ranks == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  printf("%-14s %10s %8s %8s %14s %14s\n", "mode", "keys", "zipf s", "load",
+         "steps/lookup", "lookup Mops/s");
+  int found = bench_run("static", 0, keys, count, exponent, ranks);
+  found += bench_run("move-to-front", HT_MOVE_TO_FRONT, keys, count, exponent,
+                     ranks);
+
+  free(ranks);
+  bench_free_keys(keys);
+  if (found != 2 * BENCH_LOOKUPS) {
+    fprintf(stderr, "found %i of %i keys\n", found, 2 * BENCH_LOOKUPS);
+    return 1;
+  }
+  return 0;
+}
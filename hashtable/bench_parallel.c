@@ -0,0 +1,109 @@
+/*
+ * Paralelní agregace (ht_insert_parallel) s počtem vláken.
+ *
+ * Vytvoří zadaný počet dvojic, jejichž klíče se vybírají náhodně ze
+ * zadaného počtu různých klíčů, a sečte hodnoty podle klíčů do prázdné
+ * tabulky: jednou postupně funkcí ht_upsert, jak se agregovalo dosud,
+ * a pak funkcí ht_insert_parallel s 1, 2, 4, ... vlákny. Výsledek každého
+ * běhu porovná s postupným součtem. Měří zřetězenou implementaci.
+ *
+ * Použití: ./bench_parallel [počet dvojic] [počet klíčů]
+ *                           [nejvyšší počet vláken]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef HT_CHAINED
+#error "bench_parallel requires BACKEND=chained"
+#endif
+
+#define BENCH_DEFAULT_COUNT (1 << 23)
+#define BENCH_DEFAULT_KEYS (1 << 20)
+
+static float bench_add(float value, float other) { return value + other; }
+
+static double mops(int count, uint64_t ns) { return count * 1e3 / ns; }
+
+// Vrací true, pokud mají obě tabulky stejné klíče se stejnými hodnotami
+static bool bench_same(ht_table_t *table, ht_table_t *expected, char **keys,
+                       int key_count) {
+  if (table->count != expected->count) {
+    return false;
+  }
+  for (int i = 0; i < key_count; i++) {
+    float *value = ht_get(table, keys[i]);
+    float *expected_value = ht_get(expected, keys[i]);
+    if ((value == NULL) != (expected_value == NULL) ||
+        (value != NULL && memcmp(value, expected_value, sizeof(float)) != 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  int key_count = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_KEYS;
+  int max_threads = argc > 3 ? atoi(argv[3]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (count <= 0 || key_count <= 0 || max_threads <= 0) {
+    fprintf(stderr, "usage: %s [pair count] [key count] [max threads]\n",
+            argv[0]);
+    return 1;
+  }
+  char **keys = bench_make_keys(key_count, BENCH_KEYS_RANDOM, 1);
+  ht_item_t *items = malloc(count * sizeof(ht_item_t));
+  if (keys == NULL || items == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  uint64_t state = 3;
+  for (int i = 0; i < count; i++) {
+    items[i].key = keys[bench_random(&state) % key_count];
+    items[i].value = bench_random(&state) % 100;
+  }
+
+  ht_table_t expected;
+  ht_init(&expected);
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    *ht_upsert(&expected, items[i].key, NULL) += items[i].value;
+  }
+  uint64_t sequential_ns = bench_now_ns() - start;
+
+  printf("%-10s %10s %10s %10s %10s\n", "threads", "pairs", "keys", "Mops/s",
+         "speedup");
+  printf("%-10s %10i %10i %10.2f %10.2f\n", "upsert", count, expected.count,
+         mops(count, sequential_ns), 1.0);
+  bool same = true;
+  for (int threads = 1;; threads *= 2) {
+    if (threads > max_threads) {
+      threads = max_threads;
+    }
+    ht_table_t table;
+    ht_init(&table);
+    start = bench_now_ns();
+    ht_insert_parallel(&table, items, count, threads, bench_add);
+    uint64_t ns = bench_now_ns() - start;
+    same = same && bench_same(&table, &expected, keys, key_count);
+    printf("%-10i %10i %10i %10.2f %10.2f\n", threads, count, table.count,
+           mops(count, ns), (double)sequential_ns / ns);
+    ht_delete_all(&table);
+    if (threads == max_threads) {
+      break;
+    }
+  }
+
+  ht_delete_all(&expected);
+  free(items);
+  bench_free_keys(keys);
+  if (!same) {
+    fprintf(stderr, "parallel sums differ from sequential ones\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Škálování rozdělené tabulky (ht_sharded.c) s počtem vláken při zápisu.
+ *
+ * Vlákna současně zapisují náhodné klíče ze zadaného počtu různých klíčů
+ * a každou BENCH_READ_EVERY. operací klíč čtou. Každý počet vláken 1, 2,
+ * 4, ... se měří třikrát: s jedinou tabulkou pod společným zámkem, jak se
+ * tabulka mezi vlákny sdílela dosud, s rozdělenou tabulkou po jednotlivých
+ * operacích a s rozdělenou tabulkou po dávkách BENCH_BATCH operací, kdy
+ * se každá část zamkne jednou za dávku. Implementace částí se volí při
+ * překladu, např. make bench_sharded BACKEND=swiss.
+ *
+ * Použití: ./bench_sharded [počet klíčů] [nejvyšší počet vláken]
+ *                          [počet částí]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include "ht_sharded.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_DEFAULT_THREADS 64
+#define BENCH_OPS_PER_THREAD (1 << 18)
+#define BENCH_READ_EVERY 5
+#define BENCH_BATCH 64
+
+typedef enum bench_mode {
+  BENCH_GLOBAL,  // jediná tabulka pod společným zámkem
+  BENCH_SHARDED, // rozdělená tabulka po jednotlivých operacích
+  BENCH_BATCHED  // rozdělená tabulka po dávkách
+} bench_mode_t;
+
+typedef struct bench_thread {
+  pthread_t thread;
+  bench_mode_t mode;
+  ht_table_t *table;       // tabulka režimu BENCH_GLOBAL
+  pthread_mutex_t *global; // zámek tabulky table
+  ht_sharded_t *sharded;   // tabulka ostatních režimů
+  char **keys;
+  int count;
+  uint64_t seed;
+  int found;
+  float sum; // součet přečtených hodnot pro bench_sink
+} bench_thread_t;
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+static void *bench_worker(void *arg) {
+  bench_thread_t *self = arg;
+  uint64_t state = self->seed;
+  float sum = 0;
+  // počítá se lokálně, struktury vláken sdílejí řádky vyrovnávací paměti
+  int hits = 0;
+  ht_item_t writes[BENCH_BATCH];
+  char *reads[BENCH_BATCH];
+  float values[BENCH_BATCH];
+  bool found[BENCH_BATCH];
+  int write_count = 0;
+  int read_count = 0;
+  for (int i = 0; i < BENCH_OPS_PER_THREAD; i++) {
+    char *key = self->keys[bench_random(&state) % self->count];
+    bool read = i % BENCH_READ_EVERY == 0;
+    float value;
+    switch (self->mode) {
+    case BENCH_GLOBAL:
+      pthread_mutex_lock(self->global);
+      if (read) {
+        float *stored = ht_get(self->table, key);
+        hits += stored != NULL;
+        sum += stored != NULL ? *stored : 0;
+      } else {
+        ht_insert(self->table, key, i);
+      }
+      pthread_mutex_unlock(self->global);
+      break;
+    case BENCH_SHARDED:
+      if (read) {
+        bool hit = ht_sharded_read(self->sharded, key, &value);
+        hits += hit;
+        sum += hit ? value : 0;
+      } else {
+        ht_sharded_insert(self->sharded, key, i);
+      }
+      break;
+    case BENCH_BATCHED:
+      if (read) {
+        reads[read_count++] = key;
+      } else {
+        writes[write_count].key = key;
+        writes[write_count++].value = i;
+      }
+      if (write_count == BENCH_BATCH || i + 1 == BENCH_OPS_PER_THREAD) {
+        ht_sharded_insert_batch(self->sharded, writes, write_count);
+        write_count = 0;
+      }
+      if (read_count == BENCH_BATCH || i + 1 == BENCH_OPS_PER_THREAD) {
+        ht_sharded_read_batch(self->sharded, reads, read_count, values, found);
+        for (int j = 0; j < read_count; j++) {
+          hits += found[j];
+          sum += found[j] ? values[j] : 0;
+        }
+        read_count = 0;
+      }
+      break;
+    }
+  }
+  self->found = hits;
+  self->sum = sum;
+  return NULL;
+}
+
+/*
+ * Spustí threads vláken v režimu mode nad tabulkou předem naplněnou všemi
+ * klíči a vrátí propustnost v milionech operací za sekundu. Do *found
+ * přičte počet nalezených klíčů.
+ */
+static double bench_run(bench_mode_t mode, int threads, int shards,
+                        char **keys, int count, int *found) {
+  ht_table_t table;
+  pthread_mutex_t global;
+  ht_sharded_t sharded;
+  pthread_mutex_init(&global, NULL);
+  if (mode == BENCH_GLOBAL) {
+    ht_init_size(&table, count);
+    for (int i = 0; i < count; i++) {
+      ht_insert(&table, keys[i], i);
+    }
+  } else {
+    ht_sharded_init(&sharded, shards, count);
+    for (int i = 0; i < count; i++) {
+      ht_sharded_insert(&sharded, keys[i], i);
+    }
+  }
+
+  bench_thread_t *workers = calloc(threads, sizeof(bench_thread_t));
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < threads; i++) {
+    workers[i].mode = mode;
+    workers[i].table = &table;
+    workers[i].global = &global;
+    workers[i].sharded = &sharded;
+    workers[i].keys = keys;
+    workers[i].count = count;
+    workers[i].seed = i + 1;
+    pthread_create(&workers[i].thread, NULL, bench_worker, &workers[i]);
+  }
+  float sum = 0;
+  for (int i = 0; i < threads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    *found += workers[i].found;
+    sum += workers[i].sum;
+  }
+  bench_sink = sum;
+  uint64_t ns = bench_now_ns() - start;
+
+  free(workers);
+  if (mode == BENCH_GLOBAL) {
+    ht_delete_all(&table);
+  } else {
+    ht_sharded_free(&sharded);
+  }
+  pthread_mutex_destroy(&global);
+  return (double)threads * BENCH_OPS_PER_THREAD * 1e3 / ns;
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  int max_threads = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_THREADS;
+  int shards = argc > 3 ? atoi(argv[3]) : HT_SHARDS_DEFAULT;
+  if (count <= 0 || max_threads <= 0 || shards <= 0) {
+    fprintf(stderr, "usage: %s [key count] [max threads] [shards]\n",
+            argv[0]);
+    return 1;
+  }
+  char **keys = bench_make_keys(count, BENCH_KEYS_RANDOM, 1);
+  if (keys == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  printf("%-8s %-8s %10s %8s %16s %16s %16s\n", "backend", "threads", "keys",
+         "shards", "global Mops/s", "sharded Mops/s", "batched Mops/s");
+  int found = 0;
+  int reads = 0;
+  for (int threads = 1;; threads *= 2) {
+    if (threads > max_threads) {
+      threads = max_threads;
+    }
+    double global = bench_run(BENCH_GLOBAL, threads, shards, keys, count,
+                              &found);
+    double single = bench_run(BENCH_SHARDED, threads, shards, keys, count,
+                              &found);
+    double batched = bench_run(BENCH_BATCHED, threads, shards, keys, count,
+                               &found);
+    reads += 3 * threads *
+             ((BENCH_OPS_PER_THREAD + BENCH_READ_EVERY - 1) / BENCH_READ_EVERY);
+    printf("%-8s %-8i %10i %8i %16.2f %16.2f %16.2f\n", HT_BACKEND_NAME,
+           threads, count, shards, global, single, batched);
+    if (threads == max_threads) {
+      break;
+    }
+  }
+
+  bench_free_keys(keys);
+  if (found != reads) {
+    fprintf(stderr, "found %i of %i keys\n", found, reads);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Pomocné funkce měřicích programů: klíče, hodiny, náhodná čísla
+ * a percentily.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Nejdelší klíč generovaný bench_make_keys včetně ukončovací nuly
+#define BENCH_MAX_KEY 33
+#define BENCH_MAX_LONG_KEY 129
+
+const char *BENCH_KEY_KIND_NAMES[] = {"sequential", "product", "random",
+                                      "long"};
+
+uint64_t bench_now_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+uint64_t bench_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static int compare_latency(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Vzestupné seřazení count změřených dob pro bench_percentile
+void bench_sort_latencies(uint32_t latencies[], int count) {
+  qsort(latencies, count, sizeof(uint32_t), compare_latency);
+}
+
+/*
+ * Hodnota seřazeného pole latencies délky count, pod kterou leží podíl
+ * fraction měření.
+ */
+uint32_t bench_percentile(const uint32_t latencies[], int count,
+                          double fraction) {
+  int index = fraction * count;
+  return latencies[index < count ? index : count - 1];
+}
+
+/*
+ * Vygeneruje count různých klíčů. Pole ukazatelů i samotné klíče leží v jedné
+ * alokaci, kterou uvolní bench_free_keys.
+ */
+char **bench_make_keys(int count, bench_key_kind_t kind, uint64_t seed) {
+  static const char alphabet[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  int min_length = kind == BENCH_KEYS_LONG ? BENCH_MAX_KEY - 1 : 8;
+  int max_key = kind == BENCH_KEYS_LONG ? BENCH_MAX_LONG_KEY : BENCH_MAX_KEY;
+  char **keys = malloc(count * (sizeof(char *) + max_key));
+  if (keys == NULL) {
+    return NULL;
+  }
+  char *text = (char *)(keys + count);
+  for (int i = 0; i < count; i++) {
+    keys[i] = text;
+    switch (kind) {
+    case BENCH_KEYS_SEQUENTIAL:
+      sprintf(text, "key%i", i);
+      break;
+    case BENCH_KEYS_PRODUCT:
+      sprintf(text, "PRD-%07i-%c%i", i / 26, 'A' + i % 26, i % 7);
+      break;
+    case BENCH_KEYS_RANDOM:
+    case BENCH_KEYS_LONG: {
+      int length = min_length + bench_random(&seed) % (max_key - min_length);
+      for (int j = 0; j < length; j++) {
+        text[j] = alphabet[bench_random(&seed) % (sizeof(alphabet) - 1)];
+      }
+      // index klíče na konci zaručí jedinečnost
+      sprintf(text + length - 8, "%08x", (unsigned)i);
+      break;
+    }
+    }
+    text += strlen(text) + 1;
+  }
+  return keys;
+}
+
+void bench_free_keys(char **keys) { free(keys); }
@@ -0,0 +1,30 @@
+/*
+ * Pomocné funkce sdílené měřicími programy bench_*.c (bench_util.c).
+ *
+ * Generování klíčů několika druhů, monotónní hodiny v nanosekundách,
+ * rychlý pseudonáhodný generátor a percentily změřených dob operací.
+ */
+
+#ifndef IAL_HASHTABLE_BENCH_UTIL_H
+#define IAL_HASHTABLE_BENCH_UTIL_H
+
+#include <stdint.h>
+
+typedef enum bench_key_kind {
+  BENCH_KEYS_SEQUENTIAL, // "key0", "key1", ...
+  BENCH_KEYS_PRODUCT,    // "PRD-0000000-A1", krátká ID se společnou předponou
+  BENCH_KEYS_RANDOM,     // náhodné alfanumerické řetězce délky 8 až 32
+  BENCH_KEYS_LONG        // náhodné řetězce délky 32 až 128, např. URL
+} bench_key_kind_t;
+
+extern const char *BENCH_KEY_KIND_NAMES[];
+
+uint64_t bench_now_ns();
+uint64_t bench_random(uint64_t *state);
+void bench_sort_latencies(uint32_t latencies[], int count);
+uint32_t bench_percentile(const uint32_t latencies[], int count,
+                          double fraction);
+char **bench_make_keys(int count, bench_key_kind_t kind, uint64_t seed);
+void bench_free_keys(char **keys);
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * Zátěž tabulky podle zadaného scénáře s výstupem ve formátu CSV.
+ *
+ * Vytvoří zadaný počet klíčů zvoleného druhu (sequential, product, random
+ * nebo long, viz bench_key_kind_t) a změří čtyři fáze:
+ *
+ *   insert      vložení všech klíčů funkcí ht_insert do prázdné tabulky
+ *   search      vyhledání klíčů funkcí ht_search
+ *   mixed       směs ht_get, ht_insert a ht_delete v zadaném poměru
+ *   delete_all  uvolnění tabulky funkcí ht_delete_all
+ *
+ * Klíče fází search a mixed se vybírají podle zadaného přístupu: uniform
+ * (rovnoměrně), zipf (Zipfovo rozdělení s exponentem 0,99, jiný exponent
+ * mezi 0 a 1 lze zadat jako zipf:0.8; nejčastější je klíč 0) nebo
+ * sequential (klíče popořadě dokola). Poměr fáze mixed se zadává
+ * v procentech jako čtení/vložení/smazání, např. 90/8/2. Vkládají a mažou
+ * se klíče ze stejné množiny, takže velikost tabulky kolísá kolem rovnováhy
+ * daného poměru.
+ *
+ * Pro každou fázi vypíše řádek s propustností a percentily doby jedné
+ * operace v nanosekundách. Doba se měří u každé BENCH_SAMPLE. operace, aby
+ * čtení hodin propustnost téměř neovlivnilo; fáze delete_all je jediné
+ * volání a percentily nemá. Implementace se volí při překladu, např.
+ * make bench_workload BACKEND=swiss; make bench je totéž pro zvolený
+ * BACKEND. Řádky z více běhů lze spojit a porovnávat mezi verzemi.
+ *
+ * Použití: ./bench_workload [počet klíčů] [druh klíčů] [přístup] [poměr]
+ *                           [počet operací]
+ */
+
+#include "bench_util.h"
+#include "hashtable.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_DEFAULT_OPERATIONS (1 << 22)
+#define BENCH_DEFAULT_THETA 0.99
+
+// Doba se měří u každé BENCH_SAMPLE. operace
+#define BENCH_SAMPLE 16
+
+// Součet hodnot, aby překladač měřené volání nevypustil
+volatile float bench_sink;
+
+typedef enum bench_access {
+  BENCH_UNIFORM,   // klíče rovnoměrně náhodně
+  BENCH_ZIPF,      // klíče podle Zipfova rozdělení
+  BENCH_SEQUENTIAL // klíče popořadě dokola
+} bench_access_t;
+
+/*
+ * Generátor indexů klíčů 0 až count - 1. Zipfovo rozdělení se vybírá
+ * postupem z YCSB (Gray a kol., Quickly Generating Billion-Record Synthetic
+ * Databases), který po jednom výpočtu zeta(count) vybírá v konstantním čase.
+ */
+typedef struct bench_chooser {
+  bench_access_t access;
+  int count;
+  uint64_t state; // stav bench_random
+  uint64_t next;  // další index přístupu sequential
+  double theta;
+  double zeta;  // součet 1 / i^theta pro i = 1 až count
+  double alpha; // 1 / (1 - theta)
+  double eta;
+} bench_chooser_t;
+
+static void bench_chooser_init(bench_chooser_t *chooser, bench_access_t access,
+                               int count, double theta, uint64_t seed) {
+  memset(chooser, 0, sizeof(bench_chooser_t));
+  chooser->access = access;
+  chooser->count = count;
+  chooser->state = seed;
+  chooser->theta = theta;
+  if (access == BENCH_ZIPF) {
+    for (int i = 1; i <= count; i++) {
+      chooser->zeta += 1 / pow(i, theta);
+    }
+    double zeta2 = 1 + 1 / pow(2, theta);
+    chooser->alpha = 1 / (1 - theta);
+    chooser->eta =
+        (1 - pow(2.0 / count, 1 - theta)) / (1 - zeta2 / chooser->zeta);
+  }
+}
+
+static int bench_choose(bench_chooser_t *chooser) {
+  switch (chooser->access) {
+  case BENCH_SEQUENTIAL:
+    return chooser->next++ % chooser->count;
+  case BENCH_ZIPF: {
+    double u = (bench_random(&chooser->state) >> 11) * 0x1p-53;
+    double uz = u * chooser->zeta;
+    if (uz < 1) {
+      return 0;
+    }
+    if (uz < 1 + pow(0.5, chooser->theta)) {
+      return 1 < chooser->count ? 1 : 0;
+    }
+    int index = chooser->count *
+                pow(chooser->eta * u - chooser->eta + 1, chooser->alpha);
+    return index < chooser->count ? index : chooser->count - 1;
+  }
+  default:
+    return bench_random(&chooser->state) % chooser->count;
+  }
+}
+
+/*
+ * Vypíše řádek CSV fáze phase s count operacemi za ns nanosekund
+ * a percentily samples změřených dob v poli latencies, které seřadí.
+ */
+static void bench_report(const char *phase, const char *scenario, int count,
+                         uint64_t ns, uint32_t latencies[], int samples) {
+  printf("%s,%s,%i,%.0f", phase, scenario, count,
+         ns > 0 ? count * 1e9 / ns : 0);
+  if (samples > 0) {
+    bench_sort_latencies(latencies, samples);
+    printf(",%u,%u,%u\n", bench_percentile(latencies, samples, 0.5),
+           bench_percentile(latencies, samples, 0.99),
+           bench_percentile(latencies, samples, 0.999));
+  } else {
+    printf(",,,\n");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_COUNT;
+  const char *kind_name = argc > 2 ? argv[2] : "random";
+  const char *access_name = argc > 3 ? argv[3] : "uniform";
+  const char *mix = argc > 4 ? argv[4] : "90/8/2";
+  int operations = argc > 5 ? atoi(argv[5]) : BENCH_DEFAULT_OPERATIONS;
+
+  int kind = BENCH_KEYS_SEQUENTIAL;
+  while (kind <= BENCH_KEYS_LONG &&
+         strcmp(kind_name, BENCH_KEY_KIND_NAMES[kind]) != 0) {
+    kind++;
+  }
+  bench_access_t access = BENCH_UNIFORM;
+  double theta = BENCH_DEFAULT_THETA;
+  bool known_access = strcmp(access_name, "uniform") == 0;
+  if (strcmp(access_name, "sequential") == 0) {
+    access = BENCH_SEQUENTIAL;
+    known_access = true;
+  } else if (strncmp(access_name, "zipf", 4) == 0) {
+    access = BENCH_ZIPF;
+    known_access = access_name[4] == '\0' ||
+                   sscanf(access_name, "zipf:%lf", &theta) == 1;
+  }
+  int reads;
+  int inserts;
+  int deletes;
+  bool known_mix = sscanf(mix, "%i/%i/%i", &reads, &inserts, &deletes) == 3 &&
+                   reads >= 0 && inserts >= 0 && deletes >= 0 &&
+                   reads + inserts + deletes == 100;
+  if (count <= 0 || operations <= 0 || kind > BENCH_KEYS_LONG ||
+      !known_access || theta <= 0 || theta >= 1 || !known_mix) {
+    fprintf(stderr,
+            "usage: %s [key count] [sequential|product|random|long]\n"
+            "       [uniform|zipf[:theta]|sequential] [read/insert/delete %%]\n"
+            "       [operation count]\n",
+            argv[0]);
+    return 1;
+  }
+
+  char **keys = bench_make_keys(count, kind, 1);
+  int sample_count =
+      (operations > count ? operations : count) / BENCH_SAMPLE + 1;
+  uint32_t *latencies = malloc(sample_count * sizeof(uint32_t));
+  if (keys == NULL || latencies == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  char scenario[128];
+  snprintf(scenario, sizeof(scenario), "%s,%s,%s,%s,%i", HT_BACKEND_NAME,
+           kind_name, access_name, mix, count);
+  bench_chooser_t chooser;
+  bench_chooser_init(&chooser, access, count, theta, 7);
+
+  printf("phase,backend,key_kind,access,mix,keys,ops,ops_per_s,p50_ns,"
+         "p99_ns,p999_ns\n");
+
+  ht_table_t table;
+  ht_init(&table);
+  int samples = 0;
+  uint64_t start = bench_now_ns();
+  for (int i = 0; i < count; i++) {
+    if (i % BENCH_SAMPLE == 0) {
+      uint64_t op_start = bench_now_ns();
+      ht_insert(&table, keys[i], i);
+      latencies[samples++] = bench_now_ns() - op_start;
+    } else {
+      ht_insert(&table, keys[i], i);
+    }
+  }
+  bench_report("insert", scenario, count, bench_now_ns() - start, latencies,
+               samples);
+
+  int found = 0;
+  samples = 0;
+  start = bench_now_ns();
+  for (int i = 0; i < operations; i++) {
+    char *key = keys[bench_choose(&chooser)];
+    if (i % BENCH_SAMPLE == 0) {
+      uint64_t op_start = bench_now_ns();
+      found += ht_search(&table, key) != NULL;
+      latencies[samples++] = bench_now_ns() - op_start;
+    } else {
+      found += ht_search(&table, key) != NULL;
+    }
+  }
+  bench_report("search", scenario, operations, bench_now_ns() - start,
+               latencies, samples);
+
+  // náhodné číslo 0 až 99 určí druh operace, index klíče vybírá chooser
+  uint64_t state = 5;
+  float sum = 0;
+  samples = 0;
+  start = bench_now_ns();
+  for (int i = 0; i < operations; i++) {
+    char *key = keys[bench_choose(&chooser)];
+    int roll = bench_random(&state) % 100;
+    uint64_t op_start = i % BENCH_SAMPLE == 0 ? bench_now_ns() : 0;
+    if (roll < reads) {
+      float *value = ht_get(&table, key);
+      sum += value != NULL ? *value : 0;
+    } else if (roll < reads + inserts) {
+      ht_insert(&table, key, i);
+    } else {
+      ht_delete(&table, key);
+    }
+    if (i % BENCH_SAMPLE == 0) {
+      latencies[samples++] = bench_now_ns() - op_start;
+    }
+  }
+  bench_report("mixed", scenario, operations, bench_now_ns() - start,
+               latencies, samples);
+  bench_sink = sum;
+
+  // ht_stats místo table.count, který souběžná implementace nemá
+  ht_stats_t stats;
+  ht_stats(&table, &stats);
+  int remaining = stats.count;
+  start = bench_now_ns();
+  ht_delete_all(&table);
+  bench_report("delete_all", scenario, remaining > 0 ? remaining : 1,
+               bench_now_ns() - start, latencies, 0);
+
+  free(latencies);
+  bench_free_keys(keys);
+  if (found != operations) {
+    fprintf(stderr, "found %i of %i keys\n", found, operations);
+    return 1;
+  }
+  return 0;
+}
@@ -1,42 +1,784 @@
 /*
  * Tabulka s rozptýlenými položkami
  *
- * S využitím datových typů ze souboru hashtable.h a připravených koster
- * funkcí implementujte tabulku s rozptýlenými položkami s explicitně
- * zretězenými synonymy.
+ * S využitím datových typů ze souboru hashtable.h implementujte tabulku
+ * s rozptýlenými položkami s explicitně zřetězenými synonymy.
  *
- * Při implementaci uvažujte velikost tabulky HT_SIZE.
+ * Tabulka si sama hlídá faktor naplnění. Při jeho překročení alokuje nové
+ * pole přibližně dvojnásobné velikosti a prvky do něj přesouvá postupně,
+ * vždy několik řádků při každém vložení nebo smazání, takže žádné jednotlivé
+ * volání neplatí za přesun celé tabulky. Po dobu přesunu se hledá v obou
+ * polích. Stejným způsobem se tabulka zmenšuje.
  */
 
-#include "hashtable.h"  
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
+/*
+ * Index řádku pole velikosti size pro hodnotu rozptylovací funkce hash.
+ * Místo dělení se horních 32 bitů hodnoty vynásobí velikostí, takže velikost
+ * pole nemusí být prvočíslem.
+ */
+static inline int ht_index(uint64_t hash, int size) {
+  return (int)(((hash >> 32) * (uint64_t)size) >> 32);
+}
+
+/*
+ * Zvýší počítadlo counter tabulky o n; bez HT_STATS se nepřeloží nic.
+ */
+#ifdef HT_STATS
+#define HT_COUNT(table, counter, n) ((table)->counters.counter += (n))
+#else
+#define HT_COUNT(table, counter, n) ((void)0)
+#endif
+
+/*
+ * Bitová mapa neprázdných řádků pole. Bit i je nastaven právě tehdy, když
+ * řádek i obsahuje prvek, takže průchod celou tabulkou i její vyprázdnění
+ * přeskočí 64 prázdných řádků jedním čtením slova.
+ */
+#define HT_BITS 64
+
+static inline int ht_bitmap_words(int size) {
+  return (size + HT_BITS - 1) / HT_BITS;
+}
+
+static inline void ht_bitmap_set(uint64_t *bitmap, int index) {
+  bitmap[index / HT_BITS] |= 1ULL << (index % HT_BITS);
+}
+
+static inline void ht_bitmap_clear(uint64_t *bitmap, int index) {
+  bitmap[index / HT_BITS] &= ~(1ULL << (index % HT_BITS));
+}
+
+static inline int ht_ctz64(uint64_t word) {
+#ifdef __GNUC__
+  return __builtin_ctzll(word);
+#else
+  int i = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+/*
+ * Index prvního neprázdného řádku z intervalu <from, end), nebo end, pokud
+ * jsou všechny prázdné.
+ */
+static int ht_bitmap_next(const uint64_t *bitmap, int from, int end) {
+  if (from >= end) {
+    return end;
+  }
+  int word = from / HT_BITS;
+  uint64_t bits = bitmap[word] & (~0ULL << (from % HT_BITS));
+  while (bits == 0) {
+    if (++word * HT_BITS >= end) {
+      return end;
+    }
+    bits = bitmap[word];
+  }
+  int index = word * HT_BITS + ht_ctz64(bits);
+  return index < end ? index : end;
+}
+
+/*
+ * Blokový Bloomův filtr pro volbu HT_BLOOM. Filtr pole velikosti size má
+ * ht_bloom_blocks(size) bloků o HT_BLOOM_WORDS slovech, tedy po jednom řádku
+ * vyrovnávací paměti. Klíč nastaví v každém slově svého bloku jeden bit, test
+ * tedy přečte jediný řádek. Blok se určí z dolních 32 bitů hodnoty
+ * rozptylovací funkce (řádek pole z horních), bity ve slovech z jejího
+ * vynásobení lichou konstantou.
+ */
+#define HT_BLOOM_WORDS (HT_CACHE_LINE / 8)
+
+static inline int ht_bloom_blocks(int size) {
+  return (int)((int64_t)size * HT_BLOOM_BITS / (HT_BLOOM_WORDS * 64)) + 1;
+}
+
+// Index prvního slova bloku klíče s hodnotou rozptylovací funkce hash
+static inline size_t ht_bloom_offset(int size, uint64_t hash) {
+  uint64_t block = ((hash & 0xFFFFFFFF) * ht_bloom_blocks(size)) >> 32;
+  return block * HT_BLOOM_WORDS;
+}
+
+static inline uint64_t ht_bloom_bit(uint64_t mix, int word) {
+  return 1ULL << ((mix >> (16 + 6 * word)) & 63);
+}
+
+/*
+ * Alokuje prázdný filtr pro pole velikosti size. Vrací NULL, pokud se
+ * nepodařilo alokovat paměť.
+ */
+static uint64_t *ht_bloom_alloc(int size) {
+  size_t bytes = (size_t)ht_bloom_blocks(size) * HT_CACHE_LINE;
+  uint64_t *bloom = aligned_alloc(HT_CACHE_LINE, bytes);
+  if (bloom != NULL) {
+    memset(bloom, 0, bytes);
+  }
+  return bloom;
+}
+
+static void ht_bloom_add(uint64_t *bloom, int size, uint64_t hash) {
+  uint64_t *block = bloom + ht_bloom_offset(size, hash);
+  uint64_t mix = hash * HT_PRIME_2;
+  for (int word = 0; word < HT_BLOOM_WORDS; word++) {
+    block[word] |= ht_bloom_bit(mix, word);
+  }
+}
+
+/*
+ * Vrací false, pokud klíč s hodnotou rozptylovací funkce hash v poli
+ * s filtrem bloom určitě není. Bez filtru (bloom je NULL) vrací true.
+ */
+static inline bool ht_bloom_test(const uint64_t *bloom, int size,
+                                 uint64_t hash) {
+  if (bloom == NULL) {
+    return true;
+  }
+  const uint64_t *block = bloom + ht_bloom_offset(size, hash);
+  uint64_t mix = hash * HT_PRIME_2;
+  uint64_t missing = 0;
+  for (int word = 0; word < HT_BLOOM_WORDS; word++) {
+    missing |= ht_bloom_bit(mix, word) & ~block[word];
+  }
+  return missing == 0;
+}
+
+/*
+ * Zásobník prvků tabulky. Prvky se vydávají postupně z velkých souvislých
+ * bloků a uvolněné prvky se řadí do seznamu pro opětovné použití, takže
+ * vkládání téměř nevolá malloc a prvky jedné tabulky leží blízko sebe.
+ * Celý zásobník se uvolní po blocích bez procházení jednotlivých prvků.
+ *
+ * Hlavička bloku zabírá celý první řádek vyrovnávací paměti, takže prvky
+ * velikosti 32 nebo 64 bytů nikdy nepřesahují hranici řádku.
+ */
+static void ht_pool_init(ht_pool_t *pool, int item_size) {
+  pool->slabs = NULL;
+  pool->free_items = NULL;
+  pool->used = 0;
+  pool->item_size = item_size;
+}
+
+/*
+ * Alokuje blok pro capacity prvků. Vrací NULL, pokud se nepodařilo alokovat
+ * paměť.
+ */
+static ht_slab_t *ht_slab_alloc(ht_pool_t *pool, int capacity) {
+  size_t bytes = HT_CACHE_LINE + (size_t)capacity * pool->item_size;
+  bytes = (bytes + HT_CACHE_LINE - 1) / HT_CACHE_LINE * HT_CACHE_LINE;
+  ht_slab_t *slab = aligned_alloc(HT_CACHE_LINE, bytes);
+  if (slab != NULL) {
+    slab->capacity = capacity;
+  }
+  return slab;
+}
+
+static inline ht_item_t *ht_slab_item(ht_pool_t *pool, ht_slab_t *slab,
+                                      int index) {
+  return (ht_item_t *)((char *)slab + HT_CACHE_LINE +
+                       (size_t)index * pool->item_size);
+}
+
+static ht_item_t *ht_pool_alloc(ht_pool_t *pool) {
+  ht_item_t *item = pool->free_items;
+  if (item != NULL) {
+    pool->free_items = item->next;
+    return item;
+  }
+  ht_slab_t *slab = pool->slabs;
+  if (slab == NULL || pool->used == slab->capacity) {
+    int capacity = slab == NULL ? HT_POOL_MIN_SLAB : 2 * slab->capacity;
+    if (capacity > HT_POOL_MAX_SLAB) {
+      capacity = HT_POOL_MAX_SLAB;
+    }
+    ht_slab_t *new_slab = ht_slab_alloc(pool, capacity);
+    if (new_slab == NULL) {
+      return NULL;
+    }
+    new_slab->next = slab;
+    pool->slabs = slab = new_slab;
+    pool->used = 0;
+  }
+  return ht_slab_item(pool, slab, pool->used++);
+}
+
+/*
+ * Alokuje souvislý blok právě count prvků, které jsou všechny hned vydány.
+ * Blok se zařadí za nejnovější blok, aby se z toho dál vydávaly jednotlivé
+ * prvky.
+ */
+static ht_slab_t *ht_pool_alloc_block(ht_pool_t *pool, int count) {
+  ht_slab_t *slab = ht_slab_alloc(pool, count);
+  if (slab == NULL) {
+    return NULL;
+  }
+  if (pool->slabs == NULL) {
+    slab->next = NULL;
+    pool->slabs = slab;
+    pool->used = count;
+  } else {
+    slab->next = pool->slabs->next;
+    pool->slabs->next = slab;
+  }
+  return slab;
+}
+
+static void ht_pool_free(ht_pool_t *pool, ht_item_t *item) {
+  item->next = pool->free_items;
+  pool->free_items = item;
+}
+
+static void ht_pool_release(ht_pool_t *pool) {
+  ht_slab_t *slab = pool->slabs;
+  while (slab != NULL) {
+    ht_slab_t *next = slab->next;
+    free(slab);
+    slab = next;
+  }
+  ht_pool_init(pool, pool->item_size);
+}
+
+/*
+ * Převezme do zásobníku pool všechny bloky a volné prvky zásobníku other se
+ * stejnou velikostí prvku; other pak zůstane prázdný. Nevydané prvky
+ * nejnovějšího bloku other se zařadí mezi volné, bloky other se zařadí za
+ * nejnovější blok pool.
+ */
+static void ht_pool_merge(ht_pool_t *pool, ht_pool_t *other) {
+  if (other->slabs == NULL) {
+    return;
+  }
+  if (pool->slabs == NULL) {
+    // bez bloků nemá pool ani volné prvky
+    *pool = *other;
+  } else {
+    while (other->used < other->slabs->capacity) {
+      ht_pool_free(other, ht_slab_item(other, other->slabs, other->used++));
+    }
+    ht_slab_t *last = other->slabs;
+    while (last->next != NULL) {
+      last = last->next;
+    }
+    last->next = pool->slabs->next;
+    pool->slabs->next = other->slabs;
+    while (other->free_items != NULL) {
+      ht_item_t *next = other->free_items->next;
+      ht_pool_free(pool, other->free_items);
+      other->free_items = next;
+    }
+  }
+  ht_pool_init(other, other->item_size);
+}
 
-int HT_SIZE = MAX_HT_SIZE;
+/*
+ * Paměť pro kopie dlouhých klíčů. Klíče se ukládají za sebe do bloků
+ * HT_ARENA_BLOCK bytů; klíč delší než čtvrtina bloku dostane vlastní blok.
+ * Místo smazaných klíčů se znovu nepoužije, všechny bloky se uvolní naráz
+ * s tabulkou.
+ */
+static void ht_arena_init(ht_arena_t *arena) {
+  arena->blocks = NULL;
+  arena->next = NULL;
+  arena->end = NULL;
+}
+
+static char *ht_arena_copy(ht_arena_t *arena, char *key, uint32_t length) {
+  size_t bytes = (size_t)length + 1;
+  if (bytes > (size_t)(arena->end - arena->next)) {
+    size_t block_size = bytes > HT_ARENA_BLOCK / 4 ? bytes : HT_ARENA_BLOCK;
+    ht_arena_block_t *block = malloc(sizeof(ht_arena_block_t) + block_size);
+    if (block == NULL) {
+      return NULL;
+    }
+    block->next = arena->blocks;
+    arena->blocks = block;
+    if (block_size > bytes) {
+      arena->next = (char *)(block + 1);
+      arena->end = arena->next + block_size;
+    } else {
+      return memcpy(block + 1, key, bytes);
+    }
+  }
+  char *copy = memcpy(arena->next, key, bytes);
+  arena->next += bytes;
+  return copy;
+}
+
+static void ht_arena_release(ht_arena_t *arena) {
+  ht_arena_block_t *block = arena->blocks;
+  while (block != NULL) {
+    ht_arena_block_t *next = block->next;
+    free(block);
+    block = next;
+  }
+  ht_arena_init(arena);
+}
 
 /*
- * Rozptylovací funkce která přidělí zadanému klíči index z intervalu
- * <0,HT_SIZE-1>. Ideální rozptylovací funkce by měla rozprostírat klíče
- * rovnoměrně po všech indexech. Zamyslete sa nad kvalitou zvolené funkce.
+ * Převezme do paměti arena všechny bloky paměti other, která pak zůstane
+ * prázdná. Klíče se dál kopírují do aktuálního bloku arena.
  */
-int get_hash(char *key) {
-  int result = 1;    
-  int length = strlen(key);      
-  for (int i = 0; i < length; i++) {     
-    result += key[i];      
+static void ht_arena_merge(ht_arena_t *arena, ht_arena_t *other) {
+  if (other->blocks == NULL) {
+    return;
+  }
+  if (arena->blocks == NULL) {
+    *arena = *other;
+  } else {
+    ht_arena_block_t *last = other->blocks;
+    while (last->next != NULL) {
+      last = last->next;
+    }
+    last->next = arena->blocks->next;
+    arena->blocks->next = other->blocks;
   }
-  return (result % HT_SIZE);     
+  ht_arena_init(other);
+}
+
+/*
+ * Počet bytů za prvkem, které v zásobníku zabírá stav hodin režimu
+ * HT_CACHE; vložený klíč leží až za nimi.
+ */
+static inline size_t ht_clock_bytes(const ht_table_t *table) {
+  return table->flags & HT_CACHE ? HT_CLOCK_BYTES : 0;
+}
+
+/*
+ * Vrací true, pokud se kopie klíče délky key_length alokuje samostatně
+ * a uvolňuje s prvkem. To platí v režimu HT_CACHE pro klíče, které se při
+ * HT_OWN_KEYS nevejdou za prvek, protože paměť pro klíče místo smazaných
+ * klíčů znovu nepoužije a prvky se v cache neustále vyřazují.
+ */
+static inline bool ht_key_allocated(const ht_table_t *table,
+                                    uint32_t key_length) {
+  return (table->flags & HT_OWN_KEYS) && (table->flags & HT_CACHE) &&
+         key_length >= HT_INLINE_KEY - HT_CLOCK_BYTES;
+}
+
+/*
+ * Uloží do nového prvku klíč key. Bez volby HT_OWN_KEYS si prvek ponechá
+ * ukazatel volajícího; jinak se krátký klíč zkopíruje přímo za prvek a
+ * dlouhý do paměti pro klíče, v režimu HT_CACHE do vlastní alokace. Vrací
+ * false, pokud se kopii nepodařilo alokovat.
+ */
+static bool ht_store_key(ht_table_t *table, ht_item_t *item, char *key,
+                         uint32_t key_length) {
+  size_t clock_bytes = ht_clock_bytes(table);
+  if (!(table->flags & HT_OWN_KEYS)) {
+    item->key = key;
+  } else if (key_length < HT_INLINE_KEY - clock_bytes) {
+    item->key = memcpy((char *)(item + 1) + clock_bytes, key, key_length + 1);
+  } else if (ht_key_allocated(table, key_length)) {
+    item->key = malloc((size_t)key_length + 1);
+    if (item->key != NULL) {
+      memcpy(item->key, key, (size_t)key_length + 1);
+    }
+  } else {
+    item->key = ht_arena_copy(&table->arena, key, key_length);
+  }
+  return item->key != NULL;
+}
+
+/*
+ * Alokuje prázdné pole velikosti size, jeho bitovou mapu a s volbou
+ * HT_BLOOM i filtr (jinak *bloom nastaví na NULL). Vrací false, pokud se
+ * nepodařilo alokovat paměť; pak nedrží nic.
+ */
+static bool ht_alloc_items(ht_table_t *table, int size, ht_item_t ***items,
+                           uint64_t **occupied, uint64_t **bloom) {
+  *items = calloc(size, sizeof(ht_item_t *));
+  *occupied = calloc(ht_bitmap_words(size), sizeof(uint64_t));
+  *bloom = table->flags & HT_BLOOM ? ht_bloom_alloc(size) : NULL;
+  if (*items == NULL || *occupied == NULL ||
+      (*bloom == NULL && (table->flags & HT_BLOOM))) {
+    free(*items);
+    free(*occupied);
+    free(*bloom);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Nastaví aktuální pole tabulky a přepočítá hranice pro změnu velikosti.
+ * Tabulka nikdy neklesne pod svou počáteční velikost.
+ */
+static void ht_set_items(ht_table_t *table, ht_item_t **items,
+                         uint64_t *occupied, uint64_t *bloom, int size) {
+  table->items = items;
+  table->occupied = occupied;
+  table->bloom = bloom;
+  table->size = size;
+  table->grow_at = size * HT_MAX_LOAD_FACTOR;
+  table->shrink_at = size > table->min_size ? size * HT_MIN_LOAD_FACTOR : 0;
+}
+
+/*
+ * Zahájí změnu velikosti tabulky na new_size. Prvky zůstávají v původním
+ * poli a přesouvá je až ht_migrate. Přesunem do pole stejné velikosti se
+ * znovu zostaví filtr HT_BLOOM. Pokud přesun ještě probíhá nebo se
+ * nepodaří alokovat nové pole, tabulka zůstává beze změny.
+ */
+static void ht_resize(ht_table_t *table, int new_size) {
+  ht_item_t **items;
+  uint64_t *occupied;
+  uint64_t *bloom;
+  if (table->old_items != NULL ||
+      !ht_alloc_items(table, new_size, &items, &occupied, &bloom)) {
+    return;
+  }
+  table->old_items = table->items;
+  table->old_occupied = table->occupied;
+  table->old_bloom = table->bloom;
+  table->old_size = table->size;
+  table->migrated = 0;
+  table->bloom_stale = 0;
+  ht_set_items(table, items, occupied, bloom, new_size);
+}
+
+/*
+ * Přesune nejvýše steps neprázdných řádků původního pole do aktuálního pole.
+ * Neprázdné řádky se hledají v bitové mapě a prohledá se nejvýše deset slov
+ * mapy na krok, aby ani řídce zaplněné pole nezdrželo jedno volání. Nový
+ * řádek prvku se určí z uložené hodnoty rozptylovací funkce, klíče se tedy
+ * znovu nezpracovávají. Po přesunu posledního řádku původní pole uvolní.
+ */
+static void ht_migrate(ht_table_t *table, int steps) {
+  int end = table->old_size;
+  if (end - table->migrated > steps * 10 * HT_BITS) {
+    end = table->migrated + steps * 10 * HT_BITS;
+  }
+  while (steps > 0) {
+    int row = ht_bitmap_next(table->old_occupied, table->migrated, end);
+    table->migrated = row;
+    if (row == end) {
+      break;
+    }
+    ht_item_t *item = table->old_items[row];
+    while (item != NULL) {
+      ht_item_t *next = item->next;
+      int index = ht_index(item->hash, table->size);
+      item->next = table->items[index];
+      table->items[index] = item;
+      ht_bitmap_set(table->occupied, index);
+      if (table->bloom != NULL) {
+        ht_bloom_add(table->bloom, table->size, item->hash);
+      }
+      item = next;
+    }
+    table->old_items[row] = NULL;
+    table->migrated++;
+    steps--;
+  }
+  if (table->migrated == table->old_size) {
+    free(table->old_items);
+    free(table->old_occupied);
+    free(table->old_bloom);
+    table->old_items = NULL;
+    table->old_occupied = NULL;
+    table->old_bloom = NULL;
+    table->old_size = 0;
+    table->migrated = 0;
+  }
+}
+
+/*
+ * Po vyjmutí prvku s hodnotou rozptylovací funkce hash zruší bit řádku,
+ * ze kterého prvek pocházel, pokud řádek zůstal prázdný.
+ */
+static void ht_update_occupied(ht_table_t *table, uint64_t hash) {
+  int index = ht_index(hash, table->size);
+  if (table->items[index] == NULL) {
+    ht_bitmap_clear(table->occupied, index);
+  }
+  if (table->old_items != NULL) {
+    index = ht_index(hash, table->old_size);
+    if (index >= table->migrated && table->old_items[index] == NULL) {
+      ht_bitmap_clear(table->old_occupied, index);
+    }
+  }
+}
+
+/*
+ * Vyhledá klíč v seznamu synonym začínajícím odkazem link. Vrací ukazatel na
+ * odkaz, který na nalezený prvek ukazuje, aby jej volající mohl i vyjmout;
+ * pokud klíč v seznamu není, vrací NULL.
+ *
+ * Prvky s jinou uloženou hodnotou rozptylovací funkce nebo délkou klíče se
+ * odmítnou bez čtení jejich klíče; memcmp se volá jen na pravděpodobné shody.
+ */
+static ht_item_t **ht_chain_find(ht_table_t *table, ht_item_t **link,
+                                 char *key, uint64_t hash,
+                                 uint32_t key_length) {
+  while (*link != NULL) {
+    ht_item_t *item = *link;
+    HT_COUNT(table, probes, 1);
+    if (item->hash == hash && item->key_length == key_length &&
+        memcmp(item->key, key, key_length) == 0) {
+      return link;
+    }
+    link = &item->next;
+  }
+  return NULL;
+}
+
+/*
+ * Vyhledá klíč v aktuálním poli a během přesunu i v dosud nepřesunutém
+ * řádku původního pole. S volbou HT_BLOOM se seznam pole prochází, jen když
+ * klíč projde filtrem pole. S volbou HT_MOVE_TO_FRONT přesune nalezený
+ * prvek na začátek jeho seznamu a vrátí odkaz ze začátku řádku.
+ */
+static ht_item_t **ht_find(ht_table_t *table, char *key, uint64_t hash,
+                           uint32_t key_length) {
+  ht_item_t **head = NULL;
+  ht_item_t **link = NULL;
+  if (table->items != NULL &&
+      ht_bloom_test(table->bloom, table->size, hash)) {
+    head = &table->items[ht_index(hash, table->size)];
+    link = ht_chain_find(table, head, key, hash, key_length);
+  }
+  if (link == NULL && table->old_items != NULL) {
+    int index = ht_index(hash, table->old_size);
+    if (index >= table->migrated &&
+        ht_bloom_test(table->old_bloom, table->old_size, hash)) {
+      head = &table->old_items[index];
+      link = ht_chain_find(table, head, key, hash, key_length);
+    }
+  }
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, link != NULL);
+  HT_COUNT(table, misses, link == NULL);
+  if (link != NULL && link != head && (table->flags & HT_MOVE_TO_FRONT)) {
+    ht_item_t *item = *link;
+    *link = item->next;
+    item->next = *head;
+    *head = item;
+    link = head;
+  }
+  return link;
+}
+
+/*
+ * Režim HT_CACHE. Pole cache.clock obsahuje právě všechny prvky tabulky,
+ * cache.clock[0] až cache.clock[count - 1]. Stav hodin prvku je 32bitové
+ * slovo hned za prvkem: jeho pozice v poli clock a nejvyšší bit
+ * HT_CLOCK_USED, který nastaví každé použití prvku. Nový prvek se přidá na
+ * konec pole; na místo vyjmutého prvku se přesune poslední prvek pole,
+ * takže pole zůstává souvislé.
+ *
+ * Při vyřazování ručička prochází pole dokola, použitým prvkům příznak
+ * zruší (druhá šance) a vyřadí první prvek bez příznaku. Prvek se tak
+ * vyřadí, jen pokud nebyl použit od minulého průchodu ručičky; po jednom
+ * celém obrátce mají příznak zrušený všechny prvky, vyřazení proto v
+ * průměru stojí konstantní počet kroků.
+ */
+#define HT_CLOCK_USED 0x80000000u
+
+static inline uint32_t *ht_clock_word(ht_item_t *item) {
+  return (uint32_t *)(item + 1);
+}
+
+// Paměť prvku započtená do rozpočtu cache.max_bytes
+static inline size_t ht_item_bytes(const ht_table_t *table,
+                                   uint32_t key_length) {
+  size_t bytes = table->pool.item_size;
+  if (ht_key_allocated(table, key_length)) {
+    bytes += (size_t)key_length + 1;
+  }
+  return bytes;
+}
+
+// V režimu HT_CACHE označí nalezený prvek item (smí být NULL) za použitý
+static inline void ht_touch(ht_table_t *table, ht_item_t *item) {
+  if (item != NULL && (table->flags & HT_CACHE)) {
+    *ht_clock_word(item) |= HT_CLOCK_USED;
+  }
+}
+
+// Zařadí nový prvek na konec hodin jako použitý
+static void ht_clock_add(ht_table_t *table, ht_item_t *item) {
+  ht_cache_t *cache = &table->cache;
+  int position = table->count - 1;
+  cache->clock[position] = item;
+  *ht_clock_word(item) = (uint32_t)position | HT_CLOCK_USED;
+  cache->bytes += ht_item_bytes(table, item->key_length);
+}
+
+// Vyjme prvek z hodin; volá se před snížením počtu prvků tabulky
+static void ht_clock_remove(ht_table_t *table, ht_item_t *item) {
+  ht_cache_t *cache = &table->cache;
+  int position = *ht_clock_word(item) & ~HT_CLOCK_USED;
+  ht_item_t *last = cache->clock[table->count - 1];
+  cache->clock[position] = last;
+  *ht_clock_word(last) =
+      (*ht_clock_word(last) & HT_CLOCK_USED) | (uint32_t)position;
+  if (cache->hand >= table->count - 1) {
+    cache->hand = 0;
+  }
+  cache->bytes -= ht_item_bytes(table, item->key_length);
+  if (ht_key_allocated(table, item->key_length)) {
+    free(item->key);
+  }
+}
+
+/*
+ * Vyjme z tabulky prvek, na který ukazuje odkaz link, a uvolní jej. Pokud
+ * počet prvků klesne pod hranici, zahájí zmenšení tabulky.
+ */
+static void ht_remove(ht_table_t *table, ht_item_t **link) {
+  ht_item_t *element = *link;
+  uint64_t hash = element->hash;
+  *link = element->next;
+  if (table->flags & HT_CACHE) {
+    ht_clock_remove(table, element);
+  }
+  ht_pool_free(&table->pool, element);
+  ht_update_occupied(table, hash);
+  table->count--;
+  HT_COUNT(table, deletes, 1);
+
+  if (table->bloom != NULL) {
+    table->bloom_stale++;
+  }
+  if (table->count < table->shrink_at) {
+    int size = 2 * table->count;
+    ht_resize(table, size > table->min_size ? size : table->min_size);
+  } else if (table->bloom_stale > table->count) {
+    ht_resize(table, table->size);
+  }
+}
+
+/*
+ * Vyřadí jeden prvek vybraný ručičkou hodin. Odkaz na něj najde průchodem
+ * jeho seznamu synonym v aktuálním, případně v původním poli.
+ */
+static void ht_evict(ht_table_t *table) {
+  ht_cache_t *cache = &table->cache;
+  ht_item_t *victim = cache->clock[cache->hand];
+  while (*ht_clock_word(victim) & HT_CLOCK_USED) {
+    *ht_clock_word(victim) &= ~HT_CLOCK_USED;
+    cache->hand = cache->hand + 1 < table->count ? cache->hand + 1 : 0;
+    victim = cache->clock[cache->hand];
+  }
+  ht_item_t **link = &table->items[ht_index(victim->hash, table->size)];
+  while (*link != NULL && *link != victim) {
+    link = &(*link)->next;
+  }
+  if (*link == NULL) {
+    link = &table->old_items[ht_index(victim->hash, table->old_size)];
+    while (*link != victim) {
+      link = &(*link)->next;
+    }
+  }
+  ht_remove(table, link);
+  cache->evictions++;
+}
+
+/*
+ * Před vložením nového prvku s klíčem délky key_length vyřadí prvky, dokud
+ * se nový prvek nevejde do limitů cache, a zajistí v poli hodin místo pro
+ * nový prvek. Prvek větší než celý rozpočet bytů zůstane v tabulce sám.
+ * Vrací false, pokud se nepodařilo alokovat pole hodin.
+ */
+static bool ht_cache_reserve(ht_table_t *table, uint32_t key_length) {
+  ht_cache_t *cache = &table->cache;
+  size_t bytes = ht_item_bytes(table, key_length);
+  while (table->count > 0 &&
+         ((cache->max_items > 0 && table->count >= cache->max_items) ||
+          (cache->max_bytes > 0 && cache->bytes + bytes > cache->max_bytes))) {
+    ht_evict(table);
+  }
+  if (table->count < cache->capacity) {
+    return true;
+  }
+  int capacity = cache->capacity > 0 ? 2 * cache->capacity : 64;
+  if (cache->max_items > 0 && capacity > cache->max_items) {
+    capacity = cache->max_items;
+  }
+  ht_item_t **clock = realloc(cache->clock, capacity * sizeof(ht_item_t *));
+  if (clock == NULL) {
+    return false;
+  }
+  cache->clock = clock;
+  cache->capacity = capacity;
+  return true;
 }
 
 /*
  * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ *
+ * Počáteční velikost tabulky je HT_DEFAULT_SIZE. Pole se alokuje až při
+ * prvním vložení prvku.
  */
 void ht_init(ht_table_t *table) {
-  if(table != NULL){   
-    for(int i = 0; i < HT_SIZE; i++){        
-      (*table)[i] = NULL;    
-    }    
-  }        
+  ht_init_flags(table, HT_DEFAULT_SIZE, 0);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí.
+ *
+ * Nekladná velikost znamená HT_DEFAULT_SIZE. Malé tabulky tak zůstanou malé
+ * a velkým lze pole dimenzovat předem, aniž by se měnila velikost ostatních
+ * tabulek. Tabulka zároveň dostane vlastní náhodné semínko rozptylovací
+ * funkce.
+ */
+void ht_init_size(ht_table_t *table, int size) {
+  ht_init_flags(table, size, 0);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí a volbami HT_*.
+ */
+void ht_init_flags(ht_table_t *table, int size, unsigned flags) {
+  if (table != NULL) {
+    table->flags = flags;
+    table->min_size = size > 0 ? size : HT_DEFAULT_SIZE;
+    table->seed = ht_random_seed();
+    table->old_items = NULL;
+    table->old_occupied = NULL;
+    table->old_bloom = NULL;
+    table->old_size = 0;
+    table->migrated = 0;
+    table->count = 0;
+    table->bloom_stale = 0;
+    table->cache = (ht_cache_t){0};
+    // stav hodin v režimu HT_CACHE by prvek jinak natáhl přes hranici řádku
+    ht_pool_init(&table->pool, flags & (HT_OWN_KEYS | HT_CACHE)
+                                   ? sizeof(ht_item_t) + HT_INLINE_KEY
+                                   : sizeof(ht_item_t));
+    ht_arena_init(&table->arena);
+    ht_set_items(table, NULL, NULL, NULL, table->min_size);
+#ifdef HT_STATS
+    table->counters = (ht_counters_t){0};
+#endif
+  }
+}
+
+/*
+ * Inicializace tabulky v režimu cache (HT_CACHE) s dalšími volbami flags.
+ *
+ * Tabulka drží nejvýše max_items prvků a nejvýše max_bytes bytů paměti
+ * prvků (prvky v zásobníku a jejich samostatně alokované klíče, bez pole
+ * seznamů synonym); nula znamená bez omezení. Vložení nového klíče nad
+ * limit nejprve vyřadí málo používané prvky. Při zadaném max_items má pole
+ * hned velikost pro všechny prvky a nikdy se nemění.
+ */
+void ht_init_cache(ht_table_t *table, int max_items, size_t max_bytes,
+                   unsigned flags) {
+  if (table != NULL) {
+    int size = max_items > 0 ? max_items / HT_MAX_LOAD_FACTOR + 1 : 0;
+    ht_init_flags(table, size, flags | HT_CACHE);
+    table->cache.max_items = max_items > 0 ? max_items : 0;
+    table->cache.max_bytes = max_bytes;
+  }
 }
 
 /*
@@ -46,45 +788,805 @@ void ht_init(ht_table_t *table) {
  * hodnotu NULL.
  */
 ht_item_t *ht_search(ht_table_t *table, char *key) {
-  int index = get_hash(key);
-  ht_item_t *current = (*table)[index];          
-  while(current != NULL){
-    if(strcmp(current->key, key) == 0){
-      return current;          
-    }    
-    current = current->next;         
+  if (table == NULL || key == NULL) {
+    return NULL;
   }
-  return NULL;
-}    
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t **link = ht_find(table, key, hash, key_length);
+  return link != NULL ? *link : NULL;
+}
+
+/*
+ * Vyhledání více klíčů najednou.
+ *
+ * Do results[i] zapíše prvek s klíčem keys[i], nebo NULL. Klíče se
+ * zpracovávají po HT_BATCH_WINDOW: nejprve se pro všechny spočte hodnota
+ * rozptylovací funkce a vyžádá se načtení jejich řádků, pak se načtou
+ * začátky seznamů synonym a vyžádá se načtení prvních prvků, a teprve pak
+ * se seznamy prohledají. Čekání na paměť se tak u jednotlivých klíčů
+ * překrývá místo toho, aby se sčítalo.
+ */
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]) {
+  uint64_t hashes[HT_BATCH_WINDOW];
+  uint32_t key_lengths[HT_BATCH_WINDOW];
+  ht_item_t **rows[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    char **window = keys + start;
+    if (table == NULL || table->items == NULL) {
+      for (int i = 0; i < n; i++) {
+        results[start + i] = NULL;
+      }
+      continue;
+    }
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL) {
+        hashes[i] = ht_hash(window[i], table->seed, &key_lengths[i]);
+        rows[i] = &table->items[ht_index(hashes[i], table->size)];
+        HT_PREFETCH(rows[i]);
+        if (table->bloom != NULL) {
+          HT_PREFETCH(table->bloom + ht_bloom_offset(table->size, hashes[i]));
+        }
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL && *rows[i] != NULL) {
+        HT_PREFETCH(*rows[i]);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      ht_item_t **link = NULL;
+      if (window[i] != NULL) {
+        link = ht_find(table, window[i], hashes[i], key_lengths[i]);
+      }
+      results[start + i] = link != NULL ? *link : NULL;
+    }
+  }
+}
+
+/*
+ * Získání hodnot více klíčů najednou.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Klíče vyhledá funkcí ht_search_batch.
+ */
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]) {
+  ht_item_t *items[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    ht_search_batch(table, keys + start, n, items);
+    for (int i = 0; i < n; i++) {
+      values[start + i] = items[i] != NULL ? &items[i]->value : NULL;
+      if (table != NULL && (table->flags & HT_CACHE) &&
+          keys[start + i] != NULL) {
+        ht_touch(table, items[i]);
+        table->cache.hits += items[i] != NULL;
+        table->cache.misses += items[i] == NULL;
+      }
+    }
+  }
+}
+
+/*
+ * Přidá do tabulky nový prvek s klíčem, o kterém volající ví, že v tabulce
+ * není, a s již spočtenou hodnotou rozptylovací funkce. Prvek se vkládá na
+ * začátek seznamu synonym v aktuálním poli; v režimu HT_CACHE se pro něj
+ * předtím uvolní místo. Vrací nový prvek, nebo NULL, pokud se nepodařilo
+ * alokovat paměť.
+ */
+static ht_item_t *ht_add(ht_table_t *table, char *key, uint64_t hash,
+                         uint32_t key_length, float value) {
+  if (table->items == NULL) {
+    ht_item_t **items;
+    uint64_t *occupied;
+    uint64_t *bloom;
+    if (!ht_alloc_items(table, table->size, &items, &occupied, &bloom)) {
+      return NULL;
+    }
+    ht_set_items(table, items, occupied, bloom, table->size);
+  }
+  if (table->old_items != NULL) {
+    ht_migrate(table, HT_MIGRATE_STEP);
+  }
+  if ((table->flags & HT_CACHE) && !ht_cache_reserve(table, key_length)) {
+    return NULL;
+  }
+
+  ht_item_t *item = ht_pool_alloc(&table->pool);
+  if (item == NULL) {
+    return NULL;
+  }
+  if (!ht_store_key(table, item, key, key_length)) {
+    ht_pool_free(&table->pool, item);
+    return NULL;
+  }
+  int index = ht_index(hash, table->size);
+  item->value = value;
+  item->key_length = key_length;
+  item->hash = hash;
+  item->next = table->items[index];
+  table->items[index] = item;
+  ht_bitmap_set(table->occupied, index);
+  if (table->bloom != NULL) {
+    ht_bloom_add(table->bloom, table->size, hash);
+  }
+  table->count++;
+  HT_COUNT(table, inserts, 1);
+  if (table->flags & HT_CACHE) {
+    ht_clock_add(table, item);
+  }
+
+  if (table->count > table->grow_at && table->size <= INT_MAX / 2) {
+    ht_resize(table, 2 * table->size);
+  }
+  return item;
+}
 
 /*
  * Vložení nového prvku do tabulky.
  *
  * Pokud prvek s daným klíčem už v tabulce existuje, nahraďte jeho hodnotu.
  *
- * Při implementaci využijte funkci ht_search. Pri vkládání prvku do seznamu
- * synonym zvolte nejefektivnější možnost a vložte prvek na začátek seznamu.
+ * Klíč se zpracuje rozptylovací funkcí jen jednou a seznam synonym se
+ * projde jen jednou; nový prvek se vloží na začátek seznamu.
  */
 void ht_insert(ht_table_t *table, char *key, float value) {
-  if(table == NULL || key == NULL){    
+  if (table == NULL || key == NULL) {
     return;
   }
-  ht_item_t *current = ht_search(table, key);    
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t **link = ht_find(table, key, hash, key_length);
+  if (link != NULL) {
+    (*link)->value = value;
+    ht_touch(table, *link);
+  } else {
+    ht_add(table, key, hash, key_length, value);
+  }
+}
+
+// Velikost pole, kterou ht_build použije pro count prvků
+static int ht_build_size(const ht_table_t *table, int count) {
+  int size = count / HT_MAX_LOAD_FACTOR + 1;
+  return size < table->min_size ? table->min_size : size;
+}
+
+/*
+ * Stabilně seřadí count indexů dvojic z indices (NULL znamená 0 až
+ * count - 1) do order podle řádků pole velikosti size řazením počítáním.
+ * Pole starts musí mít size + 1 vynulovaných položek; po řazení
+ * starts[row] ukazuje na konec řádku row.
+ */
+static void ht_sort_rows(const int indices[], int count, int size,
+                         const uint64_t hashes[], int order[], int starts[]) {
+  for (int j = 0; j < count; j++) {
+    int i = indices != NULL ? indices[j] : j;
+    starts[ht_index(hashes[i], size) + 1]++;
+  }
+  for (int row = 0; row < size; row++) {
+    starts[row + 1] += starts[row];
+  }
+  // starts[row] slouží během řazení jako další volná pozice řádku row
+  for (int j = 0; j < count; j++) {
+    int i = indices != NULL ? indices[j] : j;
+    order[starts[ht_index(hashes[i], size)]++] = i;
+  }
+}
+
+/*
+ * Stabilně seřadí indexy dvojic items do order podle řádků pole velikosti
+ * size (starts musí mít size + 1 vynulovaných položek) a vynechá z každého
+ * řádku všechny dvojice se stejným klíčem kromě poslední. Vrací počet
+ * ponechaných dvojic, jejichž indexy leží na začátku order, prvky jednoho
+ * řádku za sebou.
+ */
+static int ht_group_rows(const ht_item_t items[], int count, int size,
+                         const uint64_t hashes[], const uint32_t key_lengths[],
+                         int order[], int starts[]) {
+  ht_sort_rows(NULL, count, size, hashes, order, starts);
+
+  // dvojice se posouvají jen na už zpracované pozice, takže pozdější
+  // dvojice téhož řádku zůstávají na místě pro porovnání
+  int kept = 0;
+  for (int row = 0, start = 0; row < size; start = starts[row++]) {
+    for (int j = start; j < starts[row]; j++) {
+      int i = order[j];
+      bool duplicate = false;
+      for (int k = j + 1; k < starts[row] && !duplicate; k++) {
+        int other = order[k];
+        duplicate = hashes[other] == hashes[i] &&
+                    key_lengths[other] == key_lengths[i] &&
+                    memcmp(items[other].key, items[i].key, key_lengths[i]) == 0;
+      }
+      if (!duplicate) {
+        order[kept++] = i;
+      }
+    }
+  }
+  return kept;
+}
+
+/*
+ * Vloží do prázdné tabulky count dvojic klíč–hodnota najednou. Vrací false,
+ * pokud se nepodařilo alokovat paměť; tabulka pak zůstává prázdná.
+ *
+ * Velikost pole se nejprve určí podle počtu dvojic. Všechny klíče se
+ * zpracují rozptylovací funkcí v jednom cyklu, pak se dvojice seskupí podle
+ * řádků a prvky každého řádku se uloží za sebe do jednoho bloku zásobníku,
+ * takže seznam synonym leží v paměti souvisle. Zbude-li po vynechání
+ * opakovaných klíčů nejvýše polovina dvojic, seřadí se zbylé dvojice znovu
+ * pro pole velikosti podle jejich počtu.
+ */
+static bool ht_build(ht_table_t *table, const ht_item_t items[], int count) {
+  int size = ht_build_size(table, count);
+  uint64_t *hashes = malloc(count * sizeof(uint64_t));
+  uint32_t *key_lengths = malloc(count * sizeof(uint32_t));
+  int *order = malloc(count * sizeof(int));
+  int *starts = calloc(size + 1, sizeof(int));
+  ht_item_t **rows = NULL;
+  uint64_t *occupied = NULL;
+  uint64_t *bloom = NULL;
+  bool built = hashes != NULL && key_lengths != NULL && order != NULL &&
+               starts != NULL;
+  int kept = 0;
+
+  if (built) {
+    for (int i = 0; i < count; i++) {
+      hashes[i] = ht_hash(items[i].key, table->seed, &key_lengths[i]);
+    }
+    kept =
+        ht_group_rows(items, count, size, hashes, key_lengths, order, starts);
+    int kept_size = ht_build_size(table, kept);
+    if (kept <= count / 2 && kept_size < size) {
+      // ponechané indexy leží v order[0] až order[kept - 1], seřazené se
+      // vejdou hned za ně
+      memset(starts, 0, (kept_size + 1) * sizeof(int));
+      ht_sort_rows(order, kept, kept_size, hashes, order + kept, starts);
+      memmove(order, order + kept, kept * sizeof(int));
+      size = kept_size;
+    }
+    built = ht_alloc_items(table, size, &rows, &occupied, &bloom);
+  }
+
+  if (built) {
+    ht_slab_t *slab = kept > 0 ? ht_pool_alloc_block(&table->pool, kept) : NULL;
+    built = kept == 0 || slab != NULL;
+    // prvky bloku zůstanou při chybě v zásobníku až do ht_delete_all
+    for (int j = 0; built && j < kept; j++) {
+      int i = order[j];
+      int index = ht_index(hashes[i], size);
+      ht_item_t *item = ht_slab_item(&table->pool, slab, j);
+      built = ht_store_key(table, item, items[i].key, key_lengths[i]);
+      item->value = items[i].value;
+      item->key_length = key_lengths[i];
+      item->hash = hashes[i];
+      item->next = NULL;
+      if (j + 1 < kept && ht_index(hashes[order[j + 1]], size) == index) {
+        item->next = ht_slab_item(&table->pool, slab, j + 1);
+      }
+      if (rows[index] == NULL) {
+        rows[index] = item;
+        ht_bitmap_set(occupied, index);
+      }
+      if (bloom != NULL) {
+        ht_bloom_add(bloom, size, hashes[i]);
+      }
+    }
+    if (built) {
+      free(table->items);
+      free(table->occupied);
+      free(table->bloom);
+      ht_set_items(table, rows, occupied, bloom, size);
+      table->count = kept;
+      HT_COUNT(table, inserts, kept);
+    }
+  }
+
+  free(hashes);
+  free(key_lengths);
+  free(order);
+  free(starts);
+  if (!built) {
+    free(rows);
+    free(occupied);
+    free(bloom);
+  }
+  return built;
+}
+
+/*
+ * Vložení mnoha prvků najednou.
+ *
+ * Vloží do tabulky count dvojic items[i].key, items[i].value; pro stejné
+ * klíče platí stejně jako u ht_insert hodnota poslední dvojice. Je-li
+ * tabulka prázdná, sestaví ji funkcí ht_build s polem dimenzovaným pro
+ * všechny různé klíče a se souvislými seznamy synonym. Jinak, v režimu
+ * HT_CACHE, nebo pokud se pro sestavení nepodaří alokovat paměť, dvojice
+ * vkládá postupně. Opakuje-li se v items jen několik klíčů mnohokrát, je
+ * postupné vkládání ht_insert rychlejší, protože sestavení porovnává každou
+ * dvojici s dvojicemi rozesetými po celém poli items.
+ */
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  if (table->count == 0 && table->old_items == NULL &&
+      !(table->flags & HT_CACHE) && ht_build(table, items, count)) {
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    ht_insert(table, items[i].key, items[i].value);
+  }
+}
+
+/*
+ * Vyhledání prvku, případně jeho vložení, jedinou operací.
+ *
+ * Vrací ukazatel na hodnotu prvku s klíčem key. Pokud prvek v tabulce není,
+ * vloží jej s hodnotou 0. Do *created (smí být NULL) zapíše, zda byl prvek
+ * vložen. Čítač klíče tak lze zvýšit jako (*ht_upsert(table, key, NULL))++.
+ * Při chybě alokace vrací NULL.
+ */
+float *ht_upsert(ht_table_t *table, char *key, bool *created) {
+  if (created != NULL) {
+    *created = false;
+  }
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t **link = ht_find(table, key, hash, key_length);
+  if (link != NULL) {
+    ht_touch(table, *link);
+    return &(*link)->value;
+  }
+  ht_item_t *item = ht_add(table, key, hash, key_length, 0);
+  if (item == NULL) {
+    return NULL;
+  }
+  if (created != NULL) {
+    *created = true;
+  }
+  return &item->value;
+}
+
+/*
+ * Paralelní vkládání (ht_insert_parallel). Dvojice se rozdělí do
+ * partitions = 1 << bits částí podle horních bitů hodnoty rozptylovací
+ * funkce. Protože ht_index s rostoucími horními 32 bity neklesá, padnou
+ * klíče části p do řádků p * size / partitions až
+ * (p + 1) * size / partitions - 1. Je-li velikost pole násobkem
+ * partitions * HT_BITS, vlastní tak každá část souvislý úsek řádků i celá
+ * slova bitové mapy a vlákna do pole zapisují bez zámků.
+ *
+ * Vkládání probíhá ve čtyřech fázích, mezi nimiž se vlákna spojí:
+ *  1. každé vlákno zpracuje rozptylovací funkcí svůj souvislý úsek dvojic
+ *     a spočítá, kolik z nich patří do které části,
+ *  2. zkopíruje své dvojice i s hodnotami rozptylovací funkce do pole
+ *     entries seřazeného podle částí; v rámci části zůstává pořadí vstupu,
+ *     takže další fáze čte každou část souvisle,
+ *  3. pro každou svou část naplní místní tabulku, ve které má každý nový
+ *     klíč části jediný prvek s výslednou hodnotou,
+ *  4. přepojí prvky místních tabulek do řádků cílové tabulky.
+ * Mezi fázemi 3 a 4 se pole cílové tabulky nanejvýš jednou zvětší pro
+ * všechny nové klíče.
+ */
+typedef enum ht_phase {
+  HT_PHASE_HASH,
+  HT_PHASE_SCATTER,
+  HT_PHASE_BUILD,
+  HT_PHASE_MERGE
+} ht_phase_t;
+
+// Dvojice seřazená podle částí pro fázi 3
+typedef struct ht_entry {
+  char *key;           // klíč dvojice
+  uint64_t hash;       // hodnota rozptylovací funkce klíče
+  uint32_t key_length; // délka klíče bez ukončovací nuly
+  float value;         // hodnota dvojice
+} ht_entry_t;
+
+// Společný stav jednoho volání ht_insert_parallel
+typedef struct ht_parallel {
+  ht_table_t *table;       // cílová tabulka
+  const ht_item_t *items;  // vkládané dvojice
+  int count;               // počet dvojic
+  int threads;             // počet vláken
+  int bits;                // počet bitů čísla části
+  ht_merge_t merge;        // spojení hodnot, NULL hodnotu nahrazuje
+  bool empty;              // cílová tabulka byla před vkládáním prázdná
+  uint64_t *hashes;        // hodnoty rozptylovací funkce dvojic
+  uint32_t *key_lengths;   // délky klíčů dvojic
+  ht_entry_t *entries;     // dvojice seřazené podle částí
+  int *starts;             // pro vlákno t a část p na pozici t * partitions
+                           // + p počet, po fázi 1 první pozice v entries
+  int *bounds;             // začátek každé části v entries a count na konci
+  ht_table_t *locals;      // místní tabulka každé části
+} ht_parallel_t;
+
+// Vlákno paralelního vkládání
+typedef struct ht_worker {
+  pthread_t thread;
+  ht_parallel_t *job; // společný stav
+  int index;          // číslo vlákna 0 až threads - 1
+  ht_phase_t phase;   // prováděná fáze
+  bool started;       // vlákno běží a je třeba na ně počkat
+  bool failed;        // ve fázi 3 se nepodařilo alokovat paměť
+  int added;          // prvky přidané do cílové tabulky ve fázi 4
+} ht_worker_t;
+
+static inline int ht_partition(uint64_t hash, int bits) {
+  return (int)(hash >> (64 - bits));
+}
+
+// První dvojice úseku vlákna index, pro index threads vrací count
+static inline int ht_chunk(const ht_parallel_t *job, int index) {
+  return (int)((int64_t)job->count * index / job->threads);
+}
+
+/*
+ * Vyhledá klíč v seznamu synonym začínajícím prvkem item. Nemění seznam
+ * ani počítadla, takže smí běžet ve více vláknech najednou. Vrací nalezený
+ * prvek, nebo NULL.
+ */
+static ht_item_t *ht_row_find(ht_item_t *item, char *key, uint64_t hash,
+                              uint32_t key_length) {
+  while (item != NULL &&
+         !(item->hash == hash && item->key_length == key_length &&
+           memcmp(item->key, key, key_length) == 0)) {
+    item = item->next;
+  }
+  return item;
+}
+
+// Dokončí probíhající přesun prvků do aktuálního pole.
+static void ht_migrate_all(ht_table_t *table) {
+  while (table->old_items != NULL) {
+    ht_migrate(table, HT_BITS);
+  }
+}
+
+/*
+ * Zajistí, že pole tabulky pojme count prvků bez zvětšení a jeho velikost
+ * je násobkem unit; jinak tabulku přesune do nového pole. Přesun nesmí
+ * probíhat. Vrací false, pokud se nepodařilo alokovat paměť; tabulka pak
+ * zůstává beze změny.
+ */
+static bool ht_reserve(ht_table_t *table, int64_t count, int unit) {
+  if (table->items != NULL && table->size % unit == 0 &&
+      count <= table->grow_at) {
+    return true;
+  }
+  int64_t size = (int64_t)(count / HT_MAX_LOAD_FACTOR) + 1;
+  if (size < table->size) {
+    size = table->size;
+  }
+  size = (size + unit - 1) / unit * unit;
+  if (size > INT_MAX) {
+    return false;
+  }
+  if (table->items == NULL) {
+    ht_item_t **items;
+    uint64_t *occupied;
+    uint64_t *bloom;
+    if (!ht_alloc_items(table, (int)size, &items, &occupied, &bloom)) {
+      return false;
+    }
+    ht_set_items(table, items, occupied, bloom, (int)size);
+    return true;
+  }
+  ht_resize(table, (int)size);
+  ht_migrate_all(table);
+  return table->size == size;
+}
+
+/*
+ * Fáze 3 pro část partition. Klíč, který v místní tabulce ještě není, se
+ * do ní vloží; s funkcí merge se jeho hodnota nejprve spojí s hodnotou
+ * stejného klíče v cílové tabulce, kterou v této fázi nikdo nemění. Vrací
+ * false, pokud se nepodařilo alokovat paměť.
+ */
+static bool ht_parallel_build(ht_parallel_t *job, int partition) {
+  ht_table_t *table = job->table;
+  ht_table_t *local = &job->locals[partition];
+  for (int j = job->bounds[partition]; j < job->bounds[partition + 1]; j++) {
+    char *key = job->entries[j].key;
+    float value = job->entries[j].value;
+    uint64_t hash = job->entries[j].hash;
+    uint32_t key_length = job->entries[j].key_length;
+    ht_item_t **link = ht_find(local, key, hash, key_length);
+    if (link != NULL) {
+      (*link)->value =
+          job->merge != NULL ? job->merge((*link)->value, value) : value;
+    } else {
+      if (job->merge != NULL && !job->empty &&
+          ht_bloom_test(table->bloom, table->size, hash)) {
+        ht_item_t *item = ht_row_find(table->items[ht_index(hash, table->size)],
+                                      key, hash, key_length);
+        if (item != NULL) {
+          value = job->merge(item->value, value);
+        }
+      }
+      if (ht_add(local, key, hash, key_length, value) == NULL) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * Fáze 4 pro řádky from až size - 1 pole rows místní tabulky local. Prvek,
+ * jehož klíč cílová tabulka už má, jen přepíše hodnotu cílového prvku
+ * a vrátí se do zásobníku local; ostatní se přepojí do cílového pole. Byla-li
+ * cílová tabulka prázdná (empty), přepojí se všechny prvky bez hledání.
+ * Vrací počet přepojených prvků.
+ */
+static int ht_parallel_merge(ht_table_t *table, ht_table_t *local, bool empty,
+                             ht_item_t **rows, const uint64_t *occupied,
+                             int from, int size) {
+  int added = 0;
+  for (int row = ht_bitmap_next(occupied, from, size); row < size;
+       row = ht_bitmap_next(occupied, row + 1, size)) {
+    ht_item_t *item = rows[row];
+    while (item != NULL) {
+      ht_item_t *next = item->next;
+      int index = ht_index(item->hash, table->size);
+      ht_item_t *existing =
+          empty ? NULL
+                : ht_row_find(table->items[index], item->key, item->hash,
+                              item->key_length);
+      if (existing != NULL) {
+        existing->value = item->value;
+        ht_pool_free(&local->pool, item);
+      } else {
+        item->next = table->items[index];
+        table->items[index] = item;
+        ht_bitmap_set(table->occupied, index);
+        added++;
+      }
+      item = next;
+    }
+  }
+  return added;
+}
+
+static void *ht_worker_run(void *arg) {
+  ht_worker_t *worker = arg;
+  ht_parallel_t *job = worker->job;
+  int partitions = 1 << job->bits;
+  int *starts = job->starts + worker->index * partitions;
+  int end = ht_chunk(job, worker->index + 1);
+  switch (worker->phase) {
+  case HT_PHASE_HASH:
+    for (int i = ht_chunk(job, worker->index); i < end; i++) {
+      job->hashes[i] = ht_hash(job->items[i].key, job->table->seed,
+                               &job->key_lengths[i]);
+      starts[ht_partition(job->hashes[i], job->bits)]++;
+    }
+    break;
+  case HT_PHASE_SCATTER:
+    for (int i = ht_chunk(job, worker->index); i < end; i++) {
+      ht_entry_t *entry =
+          &job->entries[starts[ht_partition(job->hashes[i], job->bits)]++];
+      entry->key = job->items[i].key;
+      entry->hash = job->hashes[i];
+      entry->key_length = job->key_lengths[i];
+      entry->value = job->items[i].value;
+    }
+    break;
+  case HT_PHASE_BUILD:
+    for (int p = worker->index; p < partitions && !worker->failed;
+         p += job->threads) {
+      worker->failed = !ht_parallel_build(job, p);
+    }
+    break;
+  case HT_PHASE_MERGE:
+    for (int p = worker->index; p < partitions; p += job->threads) {
+      ht_table_t *local = &job->locals[p];
+      if (local->items != NULL) {
+        worker->added +=
+            ht_parallel_merge(job->table, local, job->empty, local->items,
+                              local->occupied, 0, local->size);
+      }
+      if (local->old_items != NULL) {
+        worker->added += ht_parallel_merge(
+            job->table, local, job->empty, local->old_items,
+            local->old_occupied, local->migrated, local->old_size);
+      }
+    }
+    break;
+  }
+  return NULL;
+}
+
+/*
+ * Provede fázi phase ve všech vláknech a počká na jejich dokončení. Práci
+ * vlákna 0 a vláken, která se nepodařilo spustit, provede volající.
+ */
+static void ht_parallel_run(ht_worker_t workers[], int threads,
+                            ht_phase_t phase) {
+  for (int i = 0; i < threads; i++) {
+    workers[i].phase = phase;
+    workers[i].started =
+        i > 0 && pthread_create(&workers[i].thread, NULL, ht_worker_run,
+                                &workers[i]) == 0;
+  }
+  for (int i = 0; i < threads; i++) {
+    if (!workers[i].started) {
+      ht_worker_run(&workers[i]);
+    }
+  }
+  for (int i = 0; i < threads; i++) {
+    if (workers[i].started) {
+      pthread_join(workers[i].thread, NULL);
+    }
+  }
+}
+
+/*
+ * Po fázi 4 převezme cílová tabulka zásobníky a paměť klíčů místních
+ * tabulek a uvolní jejich pole. S volbou HT_BLOOM se do filtru přidají
+ * všechny prvky, protože bloky filtru se neřídí horními bity a části by je
+ * sdílely.
+ */
+static void ht_parallel_finish(ht_parallel_t *job, ht_worker_t workers[]) {
+  ht_table_t *table = job->table;
+  for (int p = 0; p < 1 << job->bits; p++) {
+    ht_table_t *local = &job->locals[p];
+    ht_pool_merge(&table->pool, &local->pool);
+    ht_arena_merge(&table->arena, &local->arena);
+    free(local->items);
+    free(local->occupied);
+    free(local->old_items);
+    free(local->old_occupied);
+  }
+  int added = 0;
+  for (int i = 0; i < job->threads; i++) {
+    added += workers[i].added;
+  }
+  table->count += added;
+  HT_COUNT(table, inserts, added);
+  if (table->bloom != NULL) {
+    for (int row = ht_bitmap_next(table->occupied, 0, table->size);
+         row < table->size;
+         row = ht_bitmap_next(table->occupied, row + 1, table->size)) {
+      for (ht_item_t *item = table->items[row]; item != NULL;
+           item = item->next) {
+        ht_bloom_add(table->bloom, table->size, item->hash);
+      }
+    }
+  }
+}
 
-  if (current != NULL) {       
-    current->value = value; 
+/*
+ * Vloží dvojice ve threads vláknech. Vrací false, pokud se nepodařilo
+ * alokovat paměť; obsah tabulky pak zůstává beze změny.
+ */
+static bool ht_insert_threads(ht_table_t *table, const ht_item_t items[],
+                              int count, int threads, ht_merge_t merge) {
+  if (threads > 1 << HT_PARALLEL_MAX_BITS) {
+    threads = 1 << HT_PARALLEL_MAX_BITS;
+  }
+  int bits = 0;
+  while (bits < HT_PARALLEL_MAX_BITS &&
+         1 << bits < threads * HT_PARALLEL_PARTITIONS) {
+    bits++;
   }
-  else {       
-    current = (ht_item_t *)malloc(sizeof(ht_item_t)); 
-    current->key = key;    
-    current->value = value;    
-    if ((*table)[get_hash(key)] == NULL){  
-      current->next = NULL;              
-    }    
-    else{
-      current->next = (*table)[get_hash(key)];   
-    }  
-    (*table)[get_hash(key)] = current;
+  int partitions = 1 << bits;
+  ht_parallel_t job = {
+      .table = table,
+      .items = items,
+      .count = count,
+      .threads = threads,
+      .bits = bits,
+      .merge = merge,
+      .empty = table->count == 0,
+      .hashes = malloc(count * sizeof(uint64_t)),
+      .key_lengths = malloc(count * sizeof(uint32_t)),
+      .entries = malloc(count * sizeof(ht_entry_t)),
+      .starts = calloc((size_t)threads * partitions, sizeof(int)),
+      .bounds = malloc((partitions + 1) * sizeof(int)),
+      .locals = malloc(partitions * sizeof(ht_table_t))};
+  ht_worker_t *workers = calloc(threads, sizeof(ht_worker_t));
+  bool inserted = job.hashes != NULL && job.key_lengths != NULL &&
+                  job.entries != NULL && job.starts != NULL &&
+                  job.bounds != NULL && job.locals != NULL && workers != NULL;
+
+  if (inserted) {
+    ht_migrate_all(table);
+    for (int i = 0; i < threads; i++) {
+      workers[i].job = &job;
+      workers[i].index = i;
+    }
+    ht_parallel_run(workers, threads, HT_PHASE_HASH);
+    int position = 0;
+    for (int p = 0; p < partitions; p++) {
+      job.bounds[p] = position;
+      for (int i = 0; i < threads; i++) {
+        int part_count = job.starts[i * partitions + p];
+        job.starts[i * partitions + p] = position;
+        position += part_count;
+      }
+    }
+    job.bounds[partitions] = position;
+    ht_parallel_run(workers, threads, HT_PHASE_SCATTER);
+
+    int64_t total = table->count;
+    for (int p = 0; p < partitions; p++) {
+      ht_init_flags(&job.locals[p], 0, table->flags & HT_OWN_KEYS);
+      job.locals[p].seed = table->seed;
+    }
+    ht_parallel_run(workers, threads, HT_PHASE_BUILD);
+    for (int i = 0; i < threads; i++) {
+      inserted = inserted && !workers[i].failed;
+    }
+    for (int p = 0; p < partitions; p++) {
+      total += job.locals[p].count;
+    }
+    inserted = inserted && ht_reserve(table, total, partitions * HT_BITS);
+    if (inserted) {
+      ht_parallel_run(workers, threads, HT_PHASE_MERGE);
+      ht_parallel_finish(&job, workers);
+    } else {
+      for (int p = 0; p < partitions; p++) {
+        ht_delete_all(&job.locals[p]);
+      }
+    }
+  }
+
+  free(job.hashes);
+  free(job.key_lengths);
+  free(job.entries);
+  free(job.starts);
+  free(job.bounds);
+  free(job.locals);
+  free(workers);
+  return inserted;
+}
+
+/*
+ * Vložení mnoha prvků ve více vláknech.
+ *
+ * Vloží do tabulky count dvojic items[i].key, items[i].value pomocí threads
+ * vláken. Bez funkce merge (NULL) je výsledek stejný jako po volání
+ * ht_insert pro všechny dvojice po řadě, tedy pro stejné klíče platí
+ * hodnota poslední dvojice. S funkcí merge se hodnota dvojice, jejíž klíč
+ * už v tabulce je, spojí s dosavadní hodnotou jako
+ * value = merge(value, items[i].value); součet výskytů klíčů tak spočítá
+ * merge vracející value + other. Spojuje se v pořadí vstupu, výsledek je
+ * proto stejný jako při postupném vkládání i pro nekomutativní merge.
+ *
+ * Dvojice se rozdělí podle hodnoty rozptylovací funkce do částí, z nichž
+ * každou zpracuje jediné vlákno ve vlastní místní tabulce a pak její prvky
+ * bez zámků přepojí do svého úseku řádků cílové tabulky (viz ht_parallel_t).
+ * Funkce merge se volá souběžně z více vláken. Při jednom vlákně, v režimu
+ * HT_CACHE, nebo pokud se nepodaří alokovat pomocnou paměť, se dvojice
+ * vkládají postupně.
+ */
+void ht_insert_parallel(ht_table_t *table, const ht_item_t items[], int count,
+                        int threads, ht_merge_t merge) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  if (threads > 1 && !(table->flags & HT_CACHE) &&
+      ht_insert_threads(table, items, count, threads, merge)) {
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    if (merge == NULL) {
+      ht_insert(table, items[i].key, items[i].value);
+    } else {
+      bool created;
+      float *value = ht_upsert(table, items[i].key, &created);
+      if (value != NULL) {
+        *value = created ? items[i].value : merge(*value, items[i].value);
+      }
+    }
   }
 }
 
@@ -92,19 +1594,25 @@ void ht_insert(ht_table_t *table, char *key, float value) {
  * Získání hodnoty z tabulky.
  *
  * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
- * případě hodnotu NULL.
+ * případě hodnotu NULL. V režimu HT_CACHE označí nalezený prvek za použitý
+ * a započte úspěch nebo neúspěch do počítadel cache.
  *
  * Při implementaci využijte funkci ht_search.
  */
-float *ht_get(ht_table_t *table, char *key) {    
-  if(table == NULL || key == NULL){      
-    return NULL;     
+float *ht_get(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return NULL;
   }
-  ht_item_t *element = ht_search(table, key);     
-  if(element != NULL){       
-    return &(element->value);   
-  }        
-  return NULL;     
+  ht_item_t *element = ht_search(table, key);
+  if (table->flags & HT_CACHE) {
+    ht_touch(table, element);
+    table->cache.hits += element != NULL;
+    table->cache.misses += element == NULL;
+  }
+  if (element != NULL) {
+    return &(element->value);
+  }
+  return NULL;
 }
 
 /*
@@ -115,50 +1623,193 @@ float *ht_get(ht_table_t *table, char *key) {
  *
  * Při implementaci NEPOUŽÍVEJTE funkci ht_search.
  */
-void ht_delete(ht_table_t *table, char *key) {       
-  if(table == NULL || key == NULL){        
-    return;      
-  }        
-  ht_item_t *element = (*table)[get_hash(key)];    
-  ht_item_t *previous = NULL;          
-  while (element != NULL) {      
-    if (strcmp(element->key, key) == 0) {              
-      if (previous != NULL){
-        previous->next = element->next;    
-      }
-      else{      
-        (*table)[get_hash(key)] = element->next;         
-      }    
-      free(element);
-      return;
-    }      
-    previous = element;    
-    element = element->next;     
+void ht_delete(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL || table->items == NULL) {
+    return;
+  }
+  if (table->old_items != NULL) {
+    ht_migrate(table, HT_MIGRATE_STEP);
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t **link = ht_find(table, key, hash, key_length);
+  if (link != NULL) {
+    ht_remove(table, link);
+  }
+}
+
+/*
+ * V režimu HT_CACHE uvolní samostatně alokované klíče všech prvků
+ * a vynuluje hodiny; prvky samotné uvolní volající se zásobníkem.
+ */
+static void ht_cache_release(ht_table_t *table) {
+  if (!(table->flags & HT_CACHE)) {
+    return;
+  }
+  for (int i = 0; i < table->count; i++) {
+    ht_item_t *item = table->cache.clock[i];
+    if (ht_key_allocated(table, item->key_length)) {
+      free(item->key);
+    }
   }
+  table->cache.hand = 0;
+  table->cache.bytes = 0;
 }
 
 /*
  * Smazání všech prvků z tabulky.
  *
- * Funkce korektně uvolní všechny alokované zdroje a uvede tabulku do stavu po 
- * inicializaci.
+ * Funkce korektně uvolní všechny alokované zdroje a uvede tabulku do stavu po
+ * inicializaci. Prvky se uvolní najednou s bloky zásobníku, seznamy synonym
+ * se tedy neprocházejí.
  */
 void ht_delete_all(ht_table_t *table) {
-  if(table == NULL){
-    return;
-  }      
-  ht_item_t *tmp;
-  for (int i = 0; i < HT_SIZE; i++) {    
-    tmp = (*table)[i];     
-    if (tmp != NULL) {         
-      ht_item_t *next;
-      while (tmp != NULL) {
-          next = tmp->next;
-          free(tmp);       
-          tmp = next;
-      }      
-      (*table)[i] = NULL;
-           
-    }      
-  }    
+  if (table == NULL) {
+    return;
+  }
+  ht_cache_release(table);
+  free(table->cache.clock);
+  table->cache.clock = NULL;
+  table->cache.capacity = 0;
+  ht_pool_release(&table->pool);
+  ht_arena_release(&table->arena);
+  free(table->items);
+  free(table->occupied);
+  free(table->bloom);
+  free(table->old_items);
+  free(table->old_occupied);
+  free(table->old_bloom);
+  table->old_items = NULL;
+  table->old_occupied = NULL;
+  table->old_bloom = NULL;
+  table->old_size = 0;
+  table->migrated = 0;
+  table->count = 0;
+  table->bloom_stale = 0;
+  ht_set_items(table, NULL, NULL, NULL, table->min_size);
+}
+
+/*
+ * Vyprázdnění tabulky pro další použití.
+ *
+ * Smaže všechny prvky jako ht_delete_all, pole počáteční velikosti ale
+ * ponechá a podle bitové mapy vynuluje jen jeho neprázdné řádky. Opakované
+ * vyprázdnění předem dimenzované tabulky tak stojí úměrně počtu prvků, ne
+ * velikosti pole, a další vkládání pole znovu nealokuje. Má-li tabulka jinou
+ * než počáteční velikost, uvolní se vše jako v ht_delete_all.
+ */
+void ht_clear(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  if (table->items == NULL || table->old_items != NULL ||
+      table->size != table->min_size) {
+    ht_delete_all(table);
+    return;
+  }
+  ht_cache_release(table);
+  ht_pool_release(&table->pool);
+  ht_arena_release(&table->arena);
+  for (int word = 0; word < ht_bitmap_words(table->size); word++) {
+    for (uint64_t bits = table->occupied[word]; bits != 0; bits &= bits - 1) {
+      table->items[word * HT_BITS + ht_ctz64(bits)] = NULL;
+    }
+    table->occupied[word] = 0;
+  }
+  if (table->bloom != NULL) {
+    memset(table->bloom, 0,
+           (size_t)ht_bloom_blocks(table->size) * HT_CACHE_LINE);
+  }
+  table->count = 0;
+  table->bloom_stale = 0;
+}
+
+/*
+ * Zavolá visit(item, context) pro každý prvek tabulky. Prázdné řádky se
+ * přeskakují podle bitové mapy. Funkce visit nesmí tabulku měnit.
+ */
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context) {
+  if (table == NULL || table->items == NULL) {
+    return;
+  }
+  for (int row = ht_bitmap_next(table->occupied, 0, table->size);
+       row < table->size;
+       row = ht_bitmap_next(table->occupied, row + 1, table->size)) {
+    for (ht_item_t *item = table->items[row]; item != NULL;
+         item = item->next) {
+      visit(item, context);
+    }
+  }
+  for (int row = ht_bitmap_next(table->old_occupied, table->migrated,
+                                table->old_size);
+       row < table->old_size;
+       row = ht_bitmap_next(table->old_occupied, row + 1, table->old_size)) {
+    for (ht_item_t *item = table->old_items[row]; item != NULL;
+         item = item->next) {
+      visit(item, context);
+    }
+  }
+}
+
+/*
+ * Faktor naplnění tabulky, tedy průměrný počet prvků na řádek pole.
+ */
+float ht_load_factor(ht_table_t *table) {
+  if (table == NULL || table->size == 0) {
+    return 0;
+  }
+  return (float)table->count / table->size;
+}
+
+/*
+ * Započte do histogramu stats délky seznamů v řádcích from až size - 1 pole
+ * items. Prochází jen neprázdné řádky podle bitové mapy occupied, prázdné
+ * se dopočtou.
+ */
+static void ht_stats_rows(ht_item_t **items, const uint64_t *occupied,
+                          int from, int size, ht_stats_t *stats) {
+  int rows = 0;
+  for (int row = ht_bitmap_next(occupied, from, size); row < size;
+       row = ht_bitmap_next(occupied, row + 1, size)) {
+    int length = 0;
+    for (ht_item_t *item = items[row]; item != NULL; item = item->next) {
+      length++;
+    }
+    stats->histogram[length < HT_STATS_BINS ? length : HT_STATS_BINS - 1]++;
+    if (length > stats->max_chain) {
+      stats->max_chain = length;
+    }
+    rows++;
+  }
+  stats->histogram[0] += size - from - rows;
+}
+
+/*
+ * Zjistí stav tabulky do *stats. Histogram délek seznamů synonym se počítá
+ * až na požádání jedním průchodem neprázdných řádků; během přesunu zahrnuje
+ * i dosud nepřesunuté řádky původního pole.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(ht_stats_t));
+  if (table == NULL) {
+    return;
+  }
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->count = table->count;
+  stats->size = table->size;
+  stats->load_factor = ht_load_factor(table);
+  if (table->items == NULL) {
+    stats->histogram[0] = table->size;
+    return;
+  }
+  ht_stats_rows(table->items, table->occupied, 0, table->size, stats);
+  if (table->old_items != NULL) {
+    ht_stats_rows(table->old_items, table->old_occupied, table->migrated,
+                  table->old_size, stats);
+  }
 }
@@ -1,42 +1,305 @@
 /*
  * Hlavičkový súbor pre tabuľku s rozptýlenými položkami.
- * Tento súbor neupravujte.
+ *
+ * Implementáciu tabuľky možno zvoliť pri preklade (v Makefile premennou
+ * BACKEND):
+ *   predvolená           explicitne zreťazené synonymá (hashtable.c)
+ *   -DHT_BACKEND_SWISS   otvorené adresovanie s riadiacimi bytmi (ht_swiss.c)
+ *   -DHT_BACKEND_CONCURRENT
+ *                        zreťazené synonymá so zámkami pre viac vlákien
+ *                        (ht_concurrent.c)
+ *   -DHT_BACKEND_ROBIN   otvorené adresovanie podľa Robin Hood (ht_robin.c)
+ *   -DHT_BACKEND_CUCKOO  kukučie rozptýlenie do skupín políčok
+ *                        (ht_cuckoo.c)
+ *   -DHT_BACKEND_UNROLLED
+ *                        zreťazené synonymá po uzloch s niekoľkými prvkami
+ *                        (ht_unrolled.c)
+ * Všetky implementácie poskytujú rovnaké funkcie ht_*. Typy ht_item_t
+ * a ht_table_t definuje zvolená implementácia, prvok má vždy položky key
+ * a value. Ukazovateľ vrátený funkciami ht_search a ht_get je platný do
+ * najbližšieho vloženia alebo zmazania prvku.
  */
 
 #ifndef IAL_HASHTABLE_H
 #define IAL_HASHTABLE_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 /*
- * Maximálna veľkosť poľa pre implementáciu tabuľky.
- * Funkcie pracujúce s tabuľkou uvažujú veľkosť HT_SIZE.
+ * Počiatočná veľkosť tabuľky, ktorú použije ht_init.
+ * Každá tabuľka si nesie vlastnú veľkosť, inú počiatočnú veľkosť možno zvoliť
+ * funkciou ht_init_size. Tabuľka sa podľa počtu prvkov sama zväčšuje
+ * a zmenšuje, nikdy však nie pod počiatočnú veľkosť.
  */
-#define MAX_HT_SIZE 101
+#define HT_DEFAULT_SIZE 101
 
 /*
- * Veľkosť tabuľky s ktorou pracujú implementované funkcie.
- * Pre účely testovania je vhodné mať možnosť meniť veľkosť tabuľky.
- * Pre správne fungovanie musí byť veľkosť prvočíslom.
+ * Počet kľúčov, ktoré ht_search_batch a ht_get_batch spracúvajú naraz:
+ * najprv pre všetky vypočítajú hodnotu rozptyľovacej funkcie a vyžiadajú
+ * načítanie riadkov tabuľky, až potom kľúče hľadajú.
  */
-extern int HT_SIZE;
+#define HT_BATCH_WINDOW 16
+
+/*
+ * Počítadlá volaní tabuľky. Vedú sa len pri preklade s -DHT_STATS
+ * (v Makefile STATS=1), inak ich ht_stats vráti nulové a tabuľka za ne nič
+ * neplatí. Každé hľadanie kľúča, aj to, ktorým začína vloženie alebo
+ * zmazanie, zvýši lookups a práve jedno z hits a misses.
+ */
+typedef struct ht_counters {
+  uint64_t lookups; // počet hľadaní kľúča
+  uint64_t hits;    // hľadania, ktoré kľúč našli
+  uint64_t misses;  // hľadania, ktoré kľúč nenašli
+  uint64_t probes;  // prvky zoznamov synonym (pri swiss skupiny, pri
+                    // unrolled uzly) prezreté pri hľadaní
+  uint64_t inserts; // pridané prvky
+  uint64_t deletes; // zmazané prvky
+} ht_counters_t;
+
+/*
+ * Počet tried histogramu v ht_stats_t; posledná trieda zahŕňa aj všetky
+ * väčšie hodnoty.
+ */
+#define HT_STATS_BINS 16
+
+#if defined(HT_BACKEND_SWISS)
+#include "ht_swiss.h"
+#elif defined(HT_BACKEND_CONCURRENT)
+#include "ht_concurrent.h"
+#elif defined(HT_BACKEND_ROBIN)
+#include "ht_robin.h"
+#elif defined(HT_BACKEND_CUCKOO)
+#include "ht_cuckoo.h"
+#elif defined(HT_BACKEND_UNROLLED)
+#include "ht_unrolled.h"
+#else
+#define HT_CHAINED
+#define HT_BACKEND_NAME "chained"
+
+/*
+ * Hranice faktoru naplnenia (počet prvkov / veľkosť poľa). Po prekročení
+ * hornej hranice sa tabuľka zväčší na približne dvojnásobok, po poklese pod
+ * dolnú hranicu sa zmenší.
+ */
+#define HT_MAX_LOAD_FACTOR 1.0
+#define HT_MIN_LOAD_FACTOR 0.125
+
+/*
+ * Počet riadkov pôvodného poľa, ktoré sa počas zmeny veľkosti presunú do
+ * nového poľa pri každom volaní ht_insert alebo ht_delete.
+ */
+#define HT_MIGRATE_STEP 4
+
+/*
+ * Počet prvkov v prvom bloku zásobníka prvkov tabuľky. Každý ďalší blok je
+ * dvakrát väčší, najviac však HT_POOL_MAX_SLAB prvkov.
+ */
+#define HT_POOL_MIN_SLAB 64
+#define HT_POOL_MAX_SLAB 65536
+
+/*
+ * Počet častí podľa začiatku hodnoty rozptyľovacej funkcie na jedno vlákno
+ * pri ht_insert_parallel. Viac častí než vlákien vyrovná ich rozdielnu
+ * veľkosť; počet častí je mocnina dvoch, najviac 1 << HT_PARALLEL_MAX_BITS.
+ */
+#define HT_PARALLEL_PARTITIONS 4
+#define HT_PARALLEL_MAX_BITS 12
+
+// Veľkosť riadku vyrovnávacej pamäte, na ktorú sú zarovnané prvky v blokoch
+#define HT_CACHE_LINE 64
+
+/*
+ * Voľby tabuľky pre ht_init_flags.
+ *
+ * HT_OWN_KEYS: tabuľka si kľúče kopíruje, volajúci ich teda nemusí udržiavať
+ * platné. Kľúče kratšie ako HT_INLINE_KEY bytov sa uložia priamo za prvok
+ * (prvok s kľúčom zaberá jeden riadok vyrovnávacej pamäte), dlhšie do
+ * priebežne alokovaných blokov veľkosti HT_ARENA_BLOCK, ktoré sa uvoľnia
+ * naraz s tabuľkou.
+ *
+ * HT_MOVE_TO_FRONT: úspešné hľadanie presunie nájdený prvok na začiatok jeho
+ * zoznamu synonym, takže často hľadané kľúče sa nájdu po menej krokoch. Aj
+ * hľadanie potom mení tabuľku; funkcia visit v ht_foreach preto nesmie
+ * volať ani ht_search a ht_get.
+ *
+ * HT_BLOOM: ku každému poľu zoznamov synonym patrí blokový Bloomov filter.
+ * Hľadanie sa najprv pozrie do jedného bloku filtra (riadku vyrovnávacej
+ * pamäte) a väčšinu chýbajúcich kľúčov odmietne bez prechádzania zoznamu.
+ * Filter má HT_BLOOM_BITS bitov na riadok poľa. Zmazanie bity nenuluje;
+ * keď počet zmazaní od poslednej zmeny veľkosti prekročí počet prvkov,
+ * tabuľka sa postupne presunie do nového poľa rovnakej veľkosti a filter sa
+ * tak zostaví znova.
+ *
+ * HT_CACHE: režim cache, ktorý zapína ht_init_cache. Tabuľka drží najviac
+ * zadaný počet prvkov a zadanú pamäť prvkov; nový kľúč nad limit najprv
+ * vyradí prvok vybraný algoritmom hodín (CLOCK, druhá šanca), ktorý
+ * v konštantnom priemernom čase napodobňuje vyradenie najdlhšie
+ * nepoužitého prvku. Za každým prvkom leží v zásobníku HT_CLOCK_BYTES
+ * bytov s jeho pozíciou na hodinách a príznakom použitia, ktorý nastaví
+ * vloženie, ht_get, ht_get_batch a ht_upsert; prvok v zásobníku preto aj
+ * bez HT_OWN_KEYS zaberá celý riadok vyrovnávacej pamäte. Kľúče kopírované pri
+ * HT_OWN_KEYS sa do prvku vojdú o HT_CLOCK_BYTES kratšie a dlhšie sa
+ * alokujú jednotlivo, aby ich vyradenie uvoľnilo.
+ */
+#define HT_OWN_KEYS 0x1
+#define HT_MOVE_TO_FRONT 0x2
+#define HT_BLOOM 0x4
+#define HT_CACHE 0x8
+#define HT_CLOCK_BYTES 8
+#define HT_BLOOM_BITS 16
+#define HT_INLINE_KEY 32
+#define HT_ARENA_BLOCK 65536
 
 // Prvok tabuľky
 typedef struct ht_item {
   char *key;            // kľúč prvku
   float value;          // hodnota prvku
+  uint32_t key_length;  // dĺžka kľúča bez ukončovacej nuly
   struct ht_item *next; // ukazateľ na ďalšie synonymum
+  uint64_t hash;        // neskrátená hodnota rozptyľovacej funkcie kľúča
 } ht_item_t;
 
-// Tabuľka o reálnej veľkosti MAX_HT_SIZE
-typedef ht_item_t *ht_table_t[MAX_HT_SIZE];
+// Blok súvislej pamäte pre prvky, za hlavičkou nasleduje capacity prvkov
+typedef struct ht_slab {
+  struct ht_slab *next; // predchádzajúci alokovaný blok
+  int capacity;         // počet prvkov v bloku
+} ht_slab_t;
 
-int get_hash(char *key);
+// Zásobník prvkov jednej tabuľky
+typedef struct ht_pool {
+  ht_slab_t *slabs;      // alokované bloky, najnovší prvý
+  ht_item_t *free_items; // uvoľnené prvky zreťazené cez next
+  int used;              // počet vydaných prvkov v najnovšom bloku
+  int item_size;         // veľkosť prvku v bytoch vrátane vloženého kľúča
+} ht_pool_t;
+
+// Blok pamäte pre kópie kľúčov, za hlavičkou nasledujú samotné kľúče
+typedef struct ht_arena_block {
+  struct ht_arena_block *next; // predchádzajúci alokovaný blok
+} ht_arena_block_t;
+
+// Pamäť pre kópie dlhých kľúčov jednej tabuľky
+typedef struct ht_arena {
+  ht_arena_block_t *blocks; // alokované bloky
+  char *next;               // prvý voľný byte aktuálneho bloku
+  char *end;                // koniec aktuálneho bloku
+} ht_arena_t;
+
+/*
+ * Stav režimu HT_CACHE. Hodiny sú pole všetkých prvkov tabuľky, ručička
+ * nimi prechádza pri hľadaní prvku na vyradenie. Počítadlá sa vedú aj bez
+ * HT_STATS a ht_delete_all ich nenuluje.
+ */
+typedef struct ht_cache {
+  ht_item_t **clock;  // prvky tabuľky v poradí hodín
+  int capacity;       // veľkosť poľa clock
+  int hand;           // pozícia ručičky hodín
+  int max_items;      // najväčší počet prvkov, 0 bez obmedzenia
+  size_t max_bytes;   // najväčšia pamäť prvkov v bytoch, 0 bez obmedzenia
+  size_t bytes;       // pamäť prvkov v zásobníku a ich samostatných kľúčov
+  uint64_t hits;      // ht_get a ht_get_batch, ktoré kľúč našli
+  uint64_t misses;    // ht_get a ht_get_batch, ktoré kľúč nenašli
+  uint64_t evictions; // prvky vyradené pre nedostatok miesta
+} ht_cache_t;
+
+// Tabuľka s premenlivou veľkosťou a postupným presúvaním prvkov
+typedef struct ht_table {
+  ht_item_t **items;      // pole zoznamov synonym, NULL pred prvým vložením
+  uint64_t *occupied;     // bitová mapa neprázdnych riadkov poľa items
+  uint64_t *bloom;        // Bloomov filter kľúčov v poli items pri HT_BLOOM
+  int size;               // veľkosť poľa items
+  ht_item_t **old_items;  // pôvodné pole počas zmeny veľkosti, inak NULL
+  uint64_t *old_occupied; // bitová mapa neprázdnych riadkov poľa old_items
+  uint64_t *old_bloom;    // Bloomov filter kľúčov v poli old_items
+  int old_size;           // veľkosť poľa old_items
+  int migrated;           // počet riadkov old_items už presunutých do items
+  int count;              // počet prvkov v tabuľke
+  int min_size;           // počiatočná a zároveň najmenšia veľkosť tabuľky
+  int grow_at;            // počet prvkov, pri ktorom sa tabuľka zväčší
+  int shrink_at;          // počet prvkov, pri ktorom sa tabuľka zmenší
+  uint64_t seed;          // semienko rozptyľovacej funkcie tejto tabuľky
+  ht_pool_t pool;         // zásobník, z ktorého sa alokujú prvky
+  ht_arena_t arena;       // kópie dlhých kľúčov pri HT_OWN_KEYS
+  unsigned flags;         // voľby tabuľky HT_*
+  int bloom_stale;        // zmazania od zostavenia filtra bloom
+  ht_cache_t cache;       // stav režimu HT_CACHE
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá volaní
+#endif
+} ht_table_t;
+
+#endif
+
+/*
+ * Funkcia volaná pre každý prvok tabuľky funkciou ht_foreach; context je
+ * ukazovateľ odovzdaný volajúcim.
+ */
+typedef void (*ht_visit_t)(ht_item_t *item, void *context);
+
+/*
+ * Stav tabuľky, ktorý na požiadanie zistí ht_stats.
+ *
+ * Pri zreťazených implementáciách je histogram[i] počet riadkov poľa
+ * s i prvkami (počas zmeny veľkosti vrátane ešte nepresunutých riadkov
+ * pôvodného poľa) a max_chain dĺžka najdlhšieho zoznamu synonym. Pri swiss je
+ * histogram[i] počet prvkov, ktoré ležia v (i + 1)-tej skupine na ceste
+ * hľadania svojho kľúča, a max_chain najväčší počet skupín, ktoré prezrie
+ * hľadanie prítomného kľúča. Pri robin je histogram[i] počet prvkov vo
+ * vzdialenosti i od domovského políčka a max_chain najväčší počet políčok,
+ * ktoré prezrie hľadanie prítomného kľúča. Pri cuckoo je histogram[0]
+ * počet prvkov v prvej a histogram[1] v druhej skupine ich kľúča. Pri
+ * unrolled je histogram ako pri zreťazených implementáciách a max_chain
+ * najväčší počet uzlov jedného zoznamu synonym.
+ */
+typedef struct ht_stats {
+  ht_counters_t counters;       // počítadlá volaní, bez HT_STATS nulové
+  int count;                    // počet prvkov
+  int size;                     // veľkosť poľa
+  float load_factor;            // faktor naplnenia
+  int max_chain;                // najdlhší zoznam synonym, viz vyššie
+  int histogram[HT_STATS_BINS]; // dĺžky zoznamov synonym, viz vyššie
+} ht_stats_t;
+
+uint64_t get_hash(char *key, uint64_t seed);
 void ht_init(ht_table_t *table);
+void ht_init_size(ht_table_t *table, int size);
 ht_item_t *ht_search(ht_table_t *table, char *key);
 void ht_insert(ht_table_t *table, char *key, float data);
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count);
 float *ht_get(ht_table_t *table, char *key);
+float *ht_upsert(ht_table_t *table, char *key, bool *created);
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]);
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]);
 void ht_delete(ht_table_t *table, char *key);
 void ht_delete_all(ht_table_t *table);
+void ht_clear(ht_table_t *table);
+float ht_load_factor(ht_table_t *table);
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context);
+void ht_stats(ht_table_t *table, ht_stats_t *stats);
+void ht_stats_print(ht_table_t *table, FILE *out);
+
+// Rozšírenia dostupné len pre zreťazenú implementáciu
+#ifdef HT_CHAINED
+/*
+ * Funkcia, ktorou ht_insert_parallel spojí doterajšiu hodnotu kľúča value
+ * s hodnotou ďalšej dvojice s rovnakým kľúčom; vracia novú hodnotu kľúča.
+ */
+typedef float (*ht_merge_t)(float value, float other);
+
+void ht_init_flags(ht_table_t *table, int size, unsigned flags);
+void ht_init_cache(ht_table_t *table, int max_items, size_t max_bytes,
+                   unsigned flags);
+void ht_insert_parallel(ht_table_t *table, const ht_item_t items[], int count,
+                        int threads, ht_merge_t merge);
+#endif
+
+// Rozšírenia dostupné len pre implementáciu so zámkami
+#ifdef HT_CONCURRENT
+bool ht_read(ht_table_t *table, char *key, float *value);
+#endif
 
 #endif
@@ -0,0 +1,815 @@
+/*
+ * Tabulka s rozptýlenými položkami bezpečná pro souběžná volání z více vláken
+ *
+ * Alternativní implementace funkcí ht_* ze souboru hashtable.h, která se
+ * použije při překladu s -DHT_BACKEND_CONCURRENT. Synonyma jsou explicitně
+ * zřetězená jako v hashtable.c.
+ *
+ * Hledání nebere žádné zámky, jen vstoupí do kritické sekce epoch
+ * (ht_epoch.c) a prochází seznamy po atomických ukazatelích. Zapisovatelé
+ * se vylučují zámky, mezi které je rozděleno HT_STRIPES skupin řádků.
+ * Nový prvek se před zveřejněním celý vyplní a do seznamu se zapojí jediným
+ * atomickým zápisem odkazu; přepsání hodnoty zapojí místo prvku jeho
+ * kopii. Odpojený prvek se neuvolní hned, ale odloží se do seznamu svého
+ * zámku a uvolní se, až jej žádný čtenář nemůže vidět.
+ *
+ * Zapisovatel určí zámek podle pole přečteného bez zámku a po jeho získání
+ * ověří, že se pole nezměnilo: pole vyměňuje jen změna velikosti, která
+ * drží všechny zámky. Změna velikosti přepojí do nového pole přímo
+ * existující prvky a odloží jen původní pole. Čtenář, který právě prochází
+ * přepojovaný seznam, může přejít do seznamu nového pole a klíč minout;
+ * změna velikosti proto po dobu přepojování drží lichou hodnotu čítače
+ * resizes a hledání, které klíč nenašlo, se zopakuje, pokud byl čítač
+ * lichý nebo se mezitím změnil (jako u sekvenčního zámku). Prvky se
+ * alokují jednotlivě funkcí malloc, protože zásobník z hashtable.c není
+ * chráněn zámkem.
+ *
+ * Ukazatele vrácené funkcemi ht_search, ht_get a ht_upsert zůstávají
+ * platné, dokud prvek některé vlákno nesmaže nebo nepřepíše jeho hodnotu.
+ * Hodnotu souběžně zapisovaného klíče bezpečně přečte ht_read.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Odkaz na prvek: začátek seznamu synonym nebo položka next
+typedef _Atomic(ht_item_t *) ht_link_t;
+
+/*
+ * Index řádku pole velikosti size pro hodnotu rozptylovací funkce hash,
+ * viz hashtable.c.
+ */
+static inline int ht_index(uint64_t hash, int size) {
+  return (int)(((hash >> 32) * (uint64_t)size) >> 32);
+}
+
+/*
+ * Zvýší počítadlo counter v části počítadel pro klíč s hodnotou hash o n.
+ * Bez HT_STATS se n jen vyhodnotí.
+ */
+#ifdef HT_STATS
+#define HT_COUNT(table, hash, counter, n)                                      \
+  atomic_fetch_add_explicit(                                                   \
+      &(table)->stripes[(hash) % HT_STRIPES].counters.counter, (n),           \
+      memory_order_relaxed)
+#else
+#define HT_COUNT(table, hash, counter, n) ((void)(n))
+#endif
+
+static inline ht_item_t *ht_load(ht_link_t *link) {
+  return atomic_load_explicit(link, memory_order_acquire);
+}
+
+static inline ht_rows_t *ht_rows(ht_table_t *table) {
+  return atomic_load_explicit(&table->rows, memory_order_acquire);
+}
+
+// Hodnota čítače změn velikosti před hledáním bez zámků
+static inline unsigned ht_resize_begin(ht_table_t *table) {
+  return atomic_load_explicit(&table->resizes, memory_order_acquire);
+}
+
+/*
+ * Vrací true, pokud hledání bez zámků započaté při hodnotě čítače resizes
+ * mohlo minout prvek, který mezitím přepojovala změna velikosti.
+ */
+static inline bool ht_resize_raced(ht_table_t *table, unsigned resizes) {
+  atomic_thread_fence(memory_order_acquire);
+  return (resizes & 1) ||
+         atomic_load_explicit(&table->resizes, memory_order_relaxed) !=
+             resizes;
+}
+
+/*
+ * Nový prvek s vyplněnými položkami, nebo NULL, pokud se nepodařilo
+ * alokovat paměť.
+ */
+static ht_item_t *ht_new_item(char *key, float value, uint32_t key_length,
+                              uint64_t hash, ht_item_t *next) {
+  ht_item_t *item = malloc(sizeof(ht_item_t));
+  if (item != NULL) {
+    item->key = key;
+    item->value = value;
+    item->key_length = key_length;
+    item->hash = hash;
+    item->retired = NULL;
+    atomic_init(&item->next, next);
+  }
+  return item;
+}
+
+/*
+ * Nové pole s size prázdnými řádky, nebo NULL.
+ */
+static ht_rows_t *ht_new_rows(int size) {
+  ht_rows_t *rows = malloc(sizeof(ht_rows_t) + size * sizeof(ht_link_t));
+  if (rows != NULL) {
+    rows->size = size;
+    rows->retired = NULL;
+    for (int i = 0; i < size; i++) {
+      atomic_init(&rows->heads[i], NULL);
+    }
+  }
+  return rows;
+}
+
+/*
+ * Uvolní pole i se všemi prvky jeho seznamů. Pole už nesmí nikdo číst.
+ */
+static void ht_free_rows(ht_rows_t *rows) {
+  for (int i = 0; i < rows->size; i++) {
+    ht_item_t *item = atomic_load_explicit(&rows->heads[i],
+                                           memory_order_relaxed);
+    while (item != NULL) {
+      ht_item_t *next = atomic_load_explicit(&item->next, memory_order_relaxed);
+      free(item);
+      item = next;
+    }
+  }
+  free(rows);
+}
+
+/*
+ * Odložené prvky a pole jednoho zámku. Vše, co bylo odpojeno v epoše E,
+ * se uvolní, jakmile globální epocha dosáhne E + 2. Prvky odloženého pole
+ * už leží v novém poli, uvolní se proto jen pole. Volající drží zámek.
+ */
+static void ht_reclaim(ht_stripe_t *stripe, uint64_t epoch) {
+  for (int i = 0; i < HT_EPOCHS; i++) {
+    ht_limbo_t *limbo = &stripe->limbo[i];
+    if (limbo->epoch + 2 > epoch) {
+      continue;
+    }
+    while (limbo->items != NULL) {
+      ht_item_t *next = limbo->items->retired;
+      free(limbo->items);
+      limbo->items = next;
+    }
+    while (limbo->rows != NULL) {
+      ht_rows_t *next = limbo->rows->retired;
+      free(limbo->rows);
+      limbo->rows = next;
+    }
+  }
+}
+
+/*
+ * Seznam odložených prvků zámku pro aktuální epochu. Uvolní přitom, co už
+ * uvolnit lze; seznam stejného indexu nese epochu nejméně o tři starší,
+ * takže je vždy prázdný. Každých HT_EPOCH_ADVANCE odložení se zkusí posunout
+ * globální epochu. Volající drží zámek.
+ */
+static ht_limbo_t *ht_limbo(ht_stripe_t *stripe) {
+  if (++stripe->retired % HT_EPOCH_ADVANCE == 0) {
+    ht_epoch_try_advance();
+  }
+  uint64_t epoch = ht_epoch_current();
+  ht_reclaim(stripe, epoch);
+  ht_limbo_t *limbo = &stripe->limbo[epoch % HT_EPOCHS];
+  limbo->epoch = epoch;
+  return limbo;
+}
+
+static void ht_retire_item(ht_stripe_t *stripe, ht_item_t *item) {
+  ht_limbo_t *limbo = ht_limbo(stripe);
+  item->retired = limbo->items;
+  limbo->items = item;
+}
+
+static void ht_retire_rows(ht_stripe_t *stripe, ht_rows_t *rows) {
+  ht_limbo_t *limbo = ht_limbo(stripe);
+  rows->retired = limbo->rows;
+  limbo->rows = rows;
+}
+
+/*
+ * Zamkne zámek řádku klíče s hodnotou hash a do *rows zapíše pole, které
+ * se nezmění, dokud volající zámek drží. Pokud pole mezitím vyměnila změna
+ * velikosti, zámek uvolní a zkusí to znovu. Zapisovatel je po dobu čekání
+ * v kritické sekci, aby přečtené pole nemohlo být uvolněno a jeho adresa
+ * použita znovu. Vrací NULL, pokud se do kritické sekce nepodařilo vstoupit.
+ */
+static ht_stripe_t *ht_lock_row(ht_table_t *table, uint64_t hash,
+                                ht_rows_t **rows) {
+  if (!ht_epoch_enter()) {
+    return NULL;
+  }
+  for (;;) {
+    *rows = ht_rows(table);
+    int size = *rows != NULL ? (*rows)->size : table->min_size;
+    ht_stripe_t *stripe = &table->stripes[ht_index(hash, size) % HT_STRIPES];
+    pthread_mutex_lock(&stripe->lock);
+    if (ht_rows(table) == *rows) {
+      return stripe;
+    }
+    pthread_mutex_unlock(&stripe->lock);
+  }
+}
+
+static void ht_unlock_row(ht_stripe_t *stripe) {
+  pthread_mutex_unlock(&stripe->lock);
+  ht_epoch_leave();
+}
+
+/*
+ * Zamkne, resp. odemkne, všechny zámky. Zámky se získávají vždy ve stejném
+ * pořadí, takže dvě současné změny velikosti na sebe nečekají navzájem.
+ */
+static void ht_lock_all(ht_table_t *table) {
+  for (int i = 0; i < HT_STRIPES; i++) {
+    pthread_mutex_lock(&table->stripes[i].lock);
+  }
+}
+
+static void ht_unlock_all(ht_table_t *table) {
+  for (int i = HT_STRIPES - 1; i >= 0; i--) {
+    pthread_mutex_unlock(&table->stripes[i].lock);
+  }
+}
+
+/*
+ * Součet počtů prvků všech zámků. Bez držení zámků je výsledek jen
+ * přibližný, slouží k rozhodnutí, zda se vyplatí zamknout celou tabulku.
+ */
+static int ht_count(ht_table_t *table) {
+  int count = 0;
+  for (int i = 0; i < HT_STRIPES; i++) {
+    count += atomic_load_explicit(&table->stripes[i].count,
+                                  memory_order_relaxed);
+  }
+  return count;
+}
+
+static void ht_add_count(ht_stripe_t *stripe, int delta) {
+  int count = atomic_load_explicit(&stripe->count, memory_order_relaxed);
+  atomic_store_explicit(&stripe->count, count + delta, memory_order_relaxed);
+}
+
+/*
+ * Přepočítá hranice pro změnu velikosti pole velikosti size. Volá se jen
+ * se všemi zámky.
+ */
+static void ht_set_limits(ht_table_t *table, int size) {
+  table->grow_at = size * HT_MAX_LOAD_FACTOR;
+  table->shrink_at = size > table->min_size ? size * HT_MIN_LOAD_FACTOR : 0;
+}
+
+/*
+ * Přepojí všechny prvky do nového pole velikosti size, zveřejní je a původní
+ * pole odloží. Prvky zůstávají na svých adresách, ukazatele na ně proto
+ * změnu velikosti přežijí. Volá se jen se všemi zámky; pokud se nepodaří
+ * alokovat paměť, tabulka zůstává beze změny.
+ */
+static void ht_rehash(ht_table_t *table, int size) {
+  ht_rows_t *rows = ht_new_rows(size);
+  if (rows == NULL) {
+    return;
+  }
+  // lichý čítač ohlásí čtenářům přepojování dřív než první změněný odkaz
+  unsigned resizes =
+      atomic_load_explicit(&table->resizes, memory_order_relaxed);
+  atomic_store_explicit(&table->resizes, resizes + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  int counts[HT_STRIPES] = {0};
+  ht_rows_t *old_rows = ht_rows(table);
+  for (int i = 0; old_rows != NULL && i < old_rows->size; i++) {
+    ht_item_t *item = ht_load(&old_rows->heads[i]);
+    while (item != NULL) {
+      ht_item_t *next = ht_load(&item->next);
+      int index = ht_index(item->hash, size);
+      atomic_store_explicit(&item->next, ht_load(&rows->heads[index]),
+                            memory_order_release);
+      atomic_store_explicit(&rows->heads[index], item, memory_order_relaxed);
+      counts[index % HT_STRIPES]++;
+      item = next;
+    }
+  }
+  atomic_store_explicit(&table->rows, rows, memory_order_release);
+  atomic_store_explicit(&table->resizes, resizes + 2, memory_order_release);
+  ht_set_limits(table, size);
+  for (int i = 0; i < HT_STRIPES; i++) {
+    atomic_store_explicit(&table->stripes[i].count, counts[i],
+                          memory_order_relaxed);
+  }
+  if (old_rows != NULL) {
+    ht_retire_rows(&table->stripes[0], old_rows);
+  }
+}
+
+/*
+ * Pod všemi zámky alokuje pole, pokud ještě neexistuje, nebo změní
+ * velikost tabulky, pokud počet prvků překročil některou z hranic. Podmínky
+ * se ověřují až pod zámky, protože tabulku mezitím mohlo změnit jiné
+ * vlákno.
+ */
+static void ht_resize(ht_table_t *table) {
+  ht_lock_all(table);
+  ht_rows_t *rows = ht_rows(table);
+  int count = ht_count(table);
+  if (rows == NULL) {
+    ht_rehash(table, table->min_size);
+  } else if (count > table->grow_at && rows->size <= INT_MAX / 2) {
+    ht_rehash(table, 2 * rows->size);
+  } else if (count < table->shrink_at) {
+    ht_rehash(table, 2 * count > table->min_size ? 2 * count
+                                                  : table->min_size);
+  }
+  ht_unlock_all(table);
+}
+
+/*
+ * Vyhledá klíč v seznamu synonym začínajícím odkazem link. Vrací nalezený
+ * prvek, nebo NULL; do *found (smí být NULL) zapíše odkaz, který na prvek
+ * ukazuje. Hledání se započte do počítadel tabulky table.
+ *
+ * Prvky s jinou uloženou hodnotou rozptylovací funkce nebo délkou klíče se
+ * odmítnou bez čtení jejich klíče, viz hashtable.c.
+ */
+static ht_item_t *ht_chain_find(ht_table_t *table, ht_link_t *link,
+                                char *key, uint64_t hash, uint32_t key_length,
+                                ht_link_t **found) {
+  ht_item_t *item;
+  int visited = 0;
+  while ((item = ht_load(link)) != NULL) {
+    visited++;
+    if (item->hash == hash && item->key_length == key_length &&
+        memcmp(item->key, key, key_length) == 0) {
+      if (found != NULL) {
+        *found = link;
+      }
+      break;
+    }
+    link = &item->next;
+  }
+  HT_COUNT(table, hash, lookups, 1);
+  HT_COUNT(table, hash, probes, visited);
+  HT_COUNT(table, hash, hits, item != NULL);
+  HT_COUNT(table, hash, misses, item == NULL);
+  return item;
+}
+
+/*
+ * Vyhledá klíč bez zámků a hodnotu nalezeného prvku zapíše do *value.
+ * Vrací nalezený prvek, nebo NULL. Hledání, které klíč minulo během změny
+ * velikosti, se zopakuje.
+ */
+static ht_item_t *ht_lookup(ht_table_t *table, char *key, uint64_t hash,
+                            uint32_t key_length, float *value) {
+  if (!ht_epoch_enter()) {
+    return NULL;
+  }
+  ht_item_t *item = NULL;
+  unsigned resizes;
+  do {
+    resizes = ht_resize_begin(table);
+    ht_rows_t *rows = ht_rows(table);
+    if (rows != NULL) {
+      item = ht_chain_find(table, &rows->heads[ht_index(hash, rows->size)],
+                           key, hash, key_length, NULL);
+    } else {
+      HT_COUNT(table, hash, lookups, 1);
+      HT_COUNT(table, hash, misses, 1);
+    }
+  } while (item == NULL && ht_resize_raced(table, resizes));
+  if (item != NULL) {
+    *value = item->value;
+  }
+  ht_epoch_leave();
+  return item;
+}
+
+/*
+ * Vyhledá klíč pod zámkem a pokud v tabulce není, přidá jej s hodnotou
+ * value. Existující prvek při overwrite nahradí kopií s hodnotou value.
+ * Vrací prvek s klíčem, nebo NULL, pokud se nepodařilo alokovat paměť; do
+ * *created zapíše, zda byl prvek přidán.
+ */
+static ht_item_t *ht_find_or_add(ht_table_t *table, char *key, float value,
+                                 bool overwrite, bool *created) {
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  *created = false;
+  ht_rows_t *rows;
+  ht_stripe_t *stripe = ht_lock_row(table, hash, &rows);
+  if (stripe != NULL && rows == NULL) {
+    ht_unlock_row(stripe);
+    ht_resize(table);
+    stripe = ht_lock_row(table, hash, &rows);
+  }
+  if (stripe == NULL) {
+    return NULL;
+  }
+  if (rows == NULL) {
+    // pole se nepodařilo alokovat
+    ht_unlock_row(stripe);
+    return NULL;
+  }
+
+  ht_link_t *head = &rows->heads[ht_index(hash, rows->size)];
+  ht_link_t *link;
+  ht_item_t *item = ht_chain_find(table, head, key, hash, key_length, &link);
+  if (item != NULL) {
+    if (overwrite && item->value != value) {
+      ht_item_t *copy = ht_new_item(item->key, value, key_length, hash,
+                                    ht_load(&item->next));
+      if (copy != NULL) {
+        atomic_store_explicit(link, copy, memory_order_release);
+        ht_retire_item(stripe, item);
+      }
+      item = copy;
+    }
+  } else {
+    item = ht_new_item(key, value, key_length, hash, ht_load(head));
+    if (item != NULL) {
+      atomic_store_explicit(head, item, memory_order_release);
+      ht_add_count(stripe, 1);
+      HT_COUNT(table, hash, inserts, 1);
+      *created = true;
+    }
+  }
+  bool check = *created && stripe->count > table->grow_at / HT_STRIPES;
+  int grow_at = table->grow_at;
+  ht_unlock_row(stripe);
+
+  if (check && ht_count(table) > grow_at) {
+    ht_resize(table);
+  }
+  return item;
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky, a to jen
+ * jednou, protože inicializuje zámky.
+ *
+ * Počáteční velikost tabulky je HT_DEFAULT_SIZE. Pole se alokuje až při
+ * prvním vložení prvku.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_size(table, HT_DEFAULT_SIZE);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí. Nekladná velikost
+ * znamená HT_DEFAULT_SIZE.
+ */
+void ht_init_size(ht_table_t *table, int size) {
+  if (table != NULL) {
+    table->min_size = size > 0 ? size : HT_DEFAULT_SIZE;
+    table->seed = ht_random_seed();
+    atomic_init(&table->rows, NULL);
+    atomic_init(&table->resizes, 0);
+    ht_set_limits(table, table->min_size);
+    for (int i = 0; i < HT_STRIPES; i++) {
+      ht_stripe_t *stripe = &table->stripes[i];
+      pthread_mutex_init(&stripe->lock, NULL);
+      atomic_init(&stripe->count, 0);
+      stripe->retired = 0;
+      memset(stripe->limbo, 0, sizeof(stripe->limbo));
+#ifdef HT_STATS
+      atomic_init(&stripe->counters.lookups, 0);
+      atomic_init(&stripe->counters.hits, 0);
+      atomic_init(&stripe->counters.misses, 0);
+      atomic_init(&stripe->counters.probes, 0);
+      atomic_init(&stripe->counters.inserts, 0);
+      atomic_init(&stripe->counters.deletes, 0);
+#endif
+    }
+  }
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  float value;
+  return ht_lookup(table, key, hash, key_length, &value);
+}
+
+/*
+ * Přečtení hodnoty klíče.
+ *
+ * Hodnotu prvku s klíčem key zapíše do *value. Vrací false, pokud klíč
+ * v tabulce není. Na rozdíl od čtení přes ukazatel z ht_get je bezpečné
+ * i souběžně s ht_insert a ht_delete téhož klíče.
+ */
+bool ht_read(ht_table_t *table, char *key, float *value) {
+  if (table == NULL || key == NULL || value == NULL) {
+    return false;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  return ht_lookup(table, key, hash, key_length, value) != NULL;
+}
+
+/*
+ * Vyhledání více klíčů najednou.
+ *
+ * Do results[i] zapíše prvek s klíčem keys[i], nebo NULL. Celé okno
+ * HT_BATCH_WINDOW klíčů se zpracuje v jedné kritické sekci: nejprve se spočtou
+ * hodnoty rozptylovací funkce a vyžádá se načtení řádků, pak prvních prvků
+ * seznamů, a teprve pak se seznamy prohledají, viz hashtable.c. Pokud
+ * některý klíč okna chybí a mezitím probíhala změna velikosti, okno se
+ * prohledá znovu.
+ */
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]) {
+  uint64_t hashes[HT_BATCH_WINDOW];
+  uint32_t key_lengths[HT_BATCH_WINDOW];
+  ht_link_t *heads[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    char **window = keys + start;
+    ht_rows_t *rows = NULL;
+    unsigned resizes = 0;
+    if (table != NULL && ht_epoch_enter()) {
+      resizes = ht_resize_begin(table);
+      rows = ht_rows(table);
+      if (rows == NULL) {
+        ht_epoch_leave();
+      }
+    }
+    if (rows == NULL) {
+      for (int i = 0; i < n; i++) {
+        results[start + i] = NULL;
+      }
+      continue;
+    }
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL) {
+        hashes[i] = ht_hash(window[i], table->seed, &key_lengths[i]);
+        heads[i] = &rows->heads[ht_index(hashes[i], rows->size)];
+        HT_PREFETCH(heads[i]);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      ht_item_t *item;
+      if (window[i] != NULL && (item = ht_load(heads[i])) != NULL) {
+        HT_PREFETCH(item);
+      }
+    }
+    bool missed = false;
+    for (int i = 0; i < n; i++) {
+      results[start + i] =
+          window[i] != NULL ? ht_chain_find(table, heads[i], window[i],
+                                            hashes[i], key_lengths[i], NULL)
+                            : NULL;
+      missed |= window[i] != NULL && results[start + i] == NULL;
+    }
+    ht_epoch_leave();
+    if (missed && ht_resize_raced(table, resizes)) {
+      start -= HT_BATCH_WINDOW;
+    }
+  }
+}
+
+/*
+ * Získání hodnot více klíčů najednou.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Klíče vyhledá funkcí ht_search_batch.
+ */
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]) {
+  ht_item_t *items[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    ht_search_batch(table, keys + start, n, items);
+    for (int i = 0; i < n; i++) {
+      values[start + i] = items[i] != NULL ? &items[i]->value : NULL;
+    }
+  }
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahradí jej kopií
+ * s novou hodnotou.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  bool created;
+  ht_find_or_add(table, key, value, true, &created);
+}
+
+/*
+ * Vložení mnoha prvků najednou.
+ *
+ * Vloží count dvojic items[i].key, items[i].value; pro stejné klíče platí
+ * hodnota poslední dvojice. Tabulka se pod všemi zámky předem jednou
+ * zvětší pro všechny dvojice, které se pak vkládají jednotlivě, aby
+ * souběžná čtení a zápisy nečekaly na celé sestavení.
+ */
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  ht_lock_all(table);
+  ht_rows_t *rows = ht_rows(table);
+  int needed = (ht_count(table) + (double)count) / HT_MAX_LOAD_FACTOR + 1;
+  if ((rows == NULL || needed > rows->size) && needed <= INT_MAX / 2) {
+    ht_rehash(table, needed > table->min_size ? needed : table->min_size);
+  }
+  ht_unlock_all(table);
+  for (int i = 0; i < count; i++) {
+    ht_insert(table, items[i].key, items[i].value);
+  }
+}
+
+/*
+ * Vyhledání prvku, případně jeho vložení s hodnotou 0, jedinou operací.
+ * Viz ht_upsert v hashtable.c. Hodnota se přes vrácený ukazatel mění bez
+ * synchronizace; měnit ji tak smí jen vlákno, když klíč souběžně nikdo
+ * nečte ani nezapisuje.
+ */
+float *ht_upsert(ht_table_t *table, char *key, bool *created) {
+  bool added = false;
+  ht_item_t *item = NULL;
+  if (table != NULL && key != NULL) {
+    item = ht_find_or_add(table, key, 0, false, &added);
+  }
+  if (created != NULL) {
+    *created = added;
+  }
+  return item != NULL ? &item->value : NULL;
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *element = ht_search(table, key);
+  return element != NULL ? &element->value : NULL;
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Prvek se pod zámkem odpojí ze seznamu a odloží, uvolní se až po uplynutí
+ * dvou epoch. Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_rows_t *rows;
+  ht_stripe_t *stripe = ht_lock_row(table, hash, &rows);
+  if (stripe == NULL) {
+    return;
+  }
+  ht_item_t *element = NULL;
+  if (rows != NULL) {
+    ht_link_t *link;
+    element = ht_chain_find(table, &rows->heads[ht_index(hash, rows->size)],
+                            key, hash, key_length, &link);
+    if (element != NULL) {
+      atomic_store_explicit(link, ht_load(&element->next),
+                            memory_order_release);
+      ht_retire_item(stripe, element);
+      ht_add_count(stripe, -1);
+      HT_COUNT(table, hash, deletes, 1);
+    }
+  }
+  bool check =
+      element != NULL && stripe->count < table->shrink_at / HT_STRIPES;
+  int shrink_at = table->shrink_at;
+  ht_unlock_row(stripe);
+
+  if (check && ht_count(table) < shrink_at) {
+    ht_resize(table);
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Pod všemi zámky odpojí pole a uvede tabulku do stavu po inicializaci.
+ * Pak počká, až pole nemůže číst žádné vlákno, uvolní je se všemi prvky
+ * a uvolní i všechny dříve odložené prvky. Nesmí se volat z kritické sekce
+ * epoch.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  ht_lock_all(table);
+  ht_rows_t *rows = atomic_exchange(&table->rows, NULL);
+  ht_set_limits(table, table->min_size);
+  for (int i = 0; i < HT_STRIPES; i++) {
+    atomic_store_explicit(&table->stripes[i].count, 0, memory_order_relaxed);
+  }
+  ht_unlock_all(table);
+
+  ht_epoch_synchronize();
+  if (rows != NULL) {
+    ht_free_rows(rows);
+  }
+  ht_lock_all(table);
+  uint64_t epoch = ht_epoch_current();
+  for (int i = 0; i < HT_STRIPES; i++) {
+    ht_reclaim(&table->stripes[i], epoch);
+  }
+  ht_unlock_all(table);
+}
+
+/*
+ * Vyprázdnění tabulky pro další použití. Pole mohou ještě číst jiná vlákna,
+ * nelze je tedy vynulovat na místě; funkce je totožná s ht_delete_all.
+ */
+void ht_clear(ht_table_t *table) { ht_delete_all(table); }
+
+/*
+ * Faktor naplnění tabulky, tedy průměrný počet prvků na řádek pole. Při
+ * souběžných změnách jde o přibližnou hodnotu.
+ */
+float ht_load_factor(ht_table_t *table) {
+  if (table == NULL || !ht_epoch_enter()) {
+    return 0;
+  }
+  ht_rows_t *rows = ht_rows(table);
+  int size = rows != NULL ? rows->size : table->min_size;
+  ht_epoch_leave();
+  return (float)ht_count(table) / size;
+}
+
+/*
+ * Zavolá visit(item, context) pro každý prvek tabulky. Tabulka se prochází
+ * bez zámků v jedné kritické sekci epoch; souběžně vložené nebo smazané
+ * prvky funkce navštívit může, ale nemusí. Funkce visit nesmí tabulku měnit.
+ */
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context) {
+  if (table == NULL || !ht_epoch_enter()) {
+    return;
+  }
+  ht_rows_t *rows = ht_rows(table);
+  for (int i = 0; rows != NULL && i < rows->size; i++) {
+    for (ht_item_t *item = ht_load(&rows->heads[i]); item != NULL;
+         item = ht_load(&item->next)) {
+      visit(item, context);
+    }
+  }
+  ht_epoch_leave();
+}
+
+/*
+ * Zjistí stav tabulky do *stats. Počítadla všech částí se sečtou a seznamy
+ * synonym se projdou bez zámků jako v ht_foreach; při souběžných změnách
+ * jde o přibližné hodnoty.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(ht_stats_t));
+  if (table == NULL || !ht_epoch_enter()) {
+    return;
+  }
+#ifdef HT_STATS
+  for (int i = 0; i < HT_STRIPES; i++) {
+    ht_stripe_counters_t *counters = &table->stripes[i].counters;
+    stats->counters.lookups += atomic_load(&counters->lookups);
+    stats->counters.hits += atomic_load(&counters->hits);
+    stats->counters.misses += atomic_load(&counters->misses);
+    stats->counters.probes += atomic_load(&counters->probes);
+    stats->counters.inserts += atomic_load(&counters->inserts);
+    stats->counters.deletes += atomic_load(&counters->deletes);
+  }
+#endif
+  ht_rows_t *rows = ht_rows(table);
+  stats->count = ht_count(table);
+  stats->size = rows != NULL ? rows->size : table->min_size;
+  stats->load_factor = (float)stats->count / stats->size;
+  if (rows == NULL) {
+    stats->histogram[0] = stats->size;
+  }
+  for (int i = 0; rows != NULL && i < rows->size; i++) {
+    int length = 0;
+    for (ht_item_t *item = ht_load(&rows->heads[i]); item != NULL;
+         item = ht_load(&item->next)) {
+      length++;
+    }
+    stats->histogram[length < HT_STATS_BINS ? length : HT_STATS_BINS - 1]++;
+    if (length > stats->max_chain) {
+      stats->max_chain = length;
+    }
+  }
+  ht_epoch_leave();
+}
@@ -0,0 +1,106 @@
+/*
+ * Typy tabuľky so zreťazenými synonymami bezpečnej pre súbežné volania
+ * z viacerých vlákien (ht_concurrent.c). Súbor sa vkladá z hashtable.h pri
+ * preklade s -DHT_BACKEND_CONCURRENT; preklad vyžaduje POSIX vlákna.
+ *
+ * Hľadanie neberie žiadne zámky. Zapisovatelia sa vylučujú po skupinách
+ * riadkov: riadky poľa sú rozdelené medzi HT_STRIPES zámkov (riadok i
+ * stráži zámok i % HT_STRIPES). Odpojené prvky a polia sa uvoľňujú až po
+ * uplynutí dvoch epoch (ht_epoch.h).
+ */
+#ifndef IAL_HASHTABLE_HT_CONCURRENT_H
+#define IAL_HASHTABLE_HT_CONCURRENT_H
+
+#include "ht_epoch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define HT_CONCURRENT
+#define HT_BACKEND_NAME "concurrent"
+
+// Hranice faktoru naplnenia, rovnaké ako pri zreťazenej implementácii
+#define HT_MAX_LOAD_FACTOR 1.0
+#define HT_MIN_LOAD_FACTOR 0.125
+
+// Počet zámkov, medzi ktoré sú rozdelené riadky tabuľky
+#define HT_STRIPES 64
+
+// Veľkosť riadku vyrovnávacej pamäte, na ktorú sú zarovnané zámky
+#define HT_CACHE_LINE 64
+
+/*
+ * Počet prvkov odložených v jednom pruhu, po ktorom sa zapisovateľ pokúsi
+ * posunúť epochu.
+ */
+#define HT_EPOCH_ADVANCE 64
+
+// Prvok tabuľky; okrem položky next sa po zverejnení nemení
+typedef struct ht_item {
+  char *key;                      // kľúč prvku
+  float value;                    // hodnota prvku
+  uint32_t key_length;            // dĺžka kľúča bez ukončovacej nuly
+  _Atomic(struct ht_item *) next; // ukazateľ na ďalšie synonymum
+  uint64_t hash;                  // neskrátená hodnota rozptyľovacej funkcie
+  struct ht_item *retired;        // ďalší odložený prvok
+} ht_item_t;
+
+// Pole zoznamov synonym spolu s jeho veľkosťou
+typedef struct ht_rows {
+  int size;                       // počet riadkov
+  struct ht_rows *retired;        // ďalšie odložené pole
+  _Atomic(ht_item_t *) heads[];   // začiatky zoznamov synonym
+} ht_rows_t;
+
+/*
+ * Prvky a polia odpojené v epoche epoch, ktoré ešte môže čítať niektoré
+ * vlákno. Prvky odloženého poľa už ležia v novom poli, uvoľní sa len pole.
+ */
+typedef struct ht_limbo {
+  uint64_t epoch;    // epocha odpojenia
+  ht_item_t *items;  // prvky zreťazené cez retired
+  ht_rows_t *rows;   // polia zreťazené cez retired
+} ht_limbo_t;
+
+#ifdef HT_STATS
+/*
+ * Časť počítadiel ht_counters_t, ktorú vlákna zvyšujú bez zámkov. Kľúč
+ * s hodnotou rozptyľovacej funkcie hash sa počíta v časti hash % HT_STRIPES.
+ */
+typedef struct ht_stripe_counters {
+  _Atomic uint64_t lookups;
+  _Atomic uint64_t hits;
+  _Atomic uint64_t misses;
+  _Atomic uint64_t probes;
+  _Atomic uint64_t inserts;
+  _Atomic uint64_t deletes;
+} ht_stripe_counters_t;
+#endif
+
+// Zámok skupiny riadkov, každý v samostatnom riadku vyrovnávacej pamäte
+typedef struct ht_stripe {
+  _Alignas(HT_CACHE_LINE) pthread_mutex_t lock;
+  _Atomic int count;             // počet prvkov v riadkoch tohto zámku
+  int retired;                   // počet doteraz odložených prvkov
+  ht_limbo_t limbo[HT_EPOCHS];   // odložené prvky posledných epoch
+#ifdef HT_STATS
+  // počítadlá volaní, mimo riadku vyrovnávacej pamäte so zámkom
+  _Alignas(HT_CACHE_LINE) ht_stripe_counters_t counters;
+#endif
+} ht_stripe_t;
+
+/*
+ * Tabuľka so zámkami zapisovateľov. Pole rows sa vymieňa len pod všetkými
+ * zámkami; čitatelia ho čítajú bez zámku. Počítadlo resizes je nepárne,
+ * kým zmena veľkosti prepája prvky do nového poľa.
+ */
+typedef struct ht_table {
+  _Atomic(ht_rows_t *) rows;        // aktuálne pole alebo NULL
+  _Atomic unsigned resizes;         // dvojnásobok počtu zmien veľkosti
+  int min_size;                     // počiatočná a najmenšia veľkosť
+  int grow_at;                      // počet prvkov, pri ktorom sa zväčší
+  int shrink_at;                    // počet prvkov, pri ktorom sa zmenší
+  uint64_t seed;                    // semienko rozptyľovacej funkcie
+  ht_stripe_t stripes[HT_STRIPES]; // zámky zapisovateľov
+} ht_table_t;
+
+#endif
@@ -0,0 +1,569 @@
+/*
+ * Tabulka s rozptýlenými položkami — kukačkové rozptylování do skupin
+ *
+ * Alternativní implementace funkcí ht_* ze souboru hashtable.h, která se
+ * použije při překladu s -DHT_BACKEND_CUCKOO. Prvky leží přímo ve skupinách
+ * po HT_BUCKET_SLOTS políčkách a každý klíč smí ležet jen v jedné ze dvou
+ * skupin: v první, kterou určí horní polovina hodnoty rozptylovací funkce,
+ * nebo ve druhé, kterou z první a značky (dolní poloviny hodnoty) určí
+ * druhá funkce. Hledání tedy prohlédne nejvýše dvě skupiny, tj. dva řádky
+ * vyrovnávací paměti, bez ohledu na naplnění tabulky.
+ *
+ * Když jsou obě skupiny nového klíče plné, vkládání hledá do šířky cestu
+ * přesunů: některý prvek se přesune do své druhé skupiny, případně z ní
+ * jiný prvek do jeho druhé skupiny atd., až k volnému políčku. Hledání
+ * prohlédne nejvýše HT_CUCKOO_SEARCH skupin a tabulku nemění; teprve
+ * nalezená cesta se provede od konce. Pokud cesta neexistuje, tabulka se
+ * zvětší.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nejmenší počet skupin; obě skupiny klíče se pak vždy liší
+#define HT_CUCKOO_MIN_BUCKETS 2
+
+// Zvýší počítadlo counter tabulky o n; bez HT_STATS se nepřeloží nic
+#ifdef HT_STATS
+#define HT_COUNT(table, counter, n) ((table)->counters.counter += (n))
+#else
+#define HT_COUNT(table, counter, n) ((void)0)
+#endif
+
+// Krok hledání cesty přesunů: skupina a odkud se do ní přišlo
+typedef struct ht_step {
+  int bucket; // skupina
+  int parent; // předchozí krok, nebo -1 pro skupiny nového klíče
+  int slot;   // políčko skupiny předchozího kroku, jehož prvek se přesune
+} ht_step_t;
+
+/*
+ * První skupina klíče s hodnotou rozptylovací funkce hash v poli, jehož
+ * počet skupin je mask + 1.
+ */
+static inline int ht_first_bucket(uint64_t hash, int mask) {
+  return (int)(hash >> 32) & mask;
+}
+
+/*
+ * Druhá skupina prvku se značkou tag, který leží ve skupině bucket (a pro
+ * prvek z druhé skupiny naopak první). Závisí jen na značce, lze ji tedy
+ * spočítat pro kterýkoli prvek bez jeho klíče. Skupina se mění o liché
+ * číslo, takže se obě skupiny vždy liší.
+ */
+static inline int ht_other_bucket(int bucket, uint32_t tag, int mask) {
+  uint32_t offset = (uint32_t)(tag * HT_PRIME_1 >> 32) | 1;
+  return (int)((bucket ^ offset) & (uint32_t)mask);
+}
+
+/*
+ * Nejmenší mocnina dvou, která pojme size políček ve skupinách, alespoň
+ * HT_CUCKOO_MIN_BUCKETS.
+ */
+static int ht_round_buckets(int size) {
+  int buckets = HT_CUCKOO_MIN_BUCKETS;
+  while (buckets * HT_BUCKET_SLOTS < size &&
+         buckets <= INT_MAX / 2 / HT_BUCKET_SLOTS) {
+    buckets *= 2;
+  }
+  return buckets;
+}
+
+/*
+ * Nastaví počet skupin tabulky a přepočítá hranice pro změnu velikosti.
+ */
+static void ht_set_buckets(ht_table_t *table, int bucket_count) {
+  table->bucket_count = bucket_count;
+  table->size = bucket_count * HT_BUCKET_SLOTS;
+  table->grow_at = table->size * HT_MAX_LOAD_FACTOR;
+  table->shrink_at =
+      table->size > table->min_size ? table->size * HT_MIN_LOAD_FACTOR : 0;
+}
+
+/*
+ * Nalezený prvek s klíčem key, nebo NULL. Načtení druhé skupiny se vyžádá
+ * hned, aby se při prohledávání první skupiny už načítala.
+ */
+static ht_item_t *ht_probe(ht_table_t *table, char *key, uint64_t hash) {
+  if (table->buckets == NULL) {
+    return NULL;
+  }
+  int mask = table->bucket_count - 1;
+  uint32_t tag = (uint32_t)hash;
+  int buckets[2];
+  buckets[0] = ht_first_bucket(hash, mask);
+  buckets[1] = ht_other_bucket(buckets[0], tag, mask);
+  HT_PREFETCH(&table->buckets[buckets[1]]);
+  for (int i = 0; i < 2; i++) {
+    HT_COUNT(table, probes, 1);
+    ht_item_t *slots = table->buckets[buckets[i]].slots;
+    for (int slot = 0; slot < HT_BUCKET_SLOTS; slot++) {
+      if (slots[slot].key != NULL && slots[slot].tag == tag &&
+          strcmp(slots[slot].key, key) == 0) {
+        return &slots[slot];
+      }
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Hledání klíče funkcí ht_probe započtené do počítadel tabulky.
+ */
+static ht_item_t *ht_find(ht_table_t *table, char *key, uint64_t hash) {
+  ht_item_t *item = ht_probe(table, key, hash);
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, item != NULL);
+  HT_COUNT(table, misses, item == NULL);
+  return item;
+}
+
+/*
+ * Index volného políčka skupiny bucket, nebo -1.
+ */
+static int ht_free_slot(ht_bucket_t *bucket) {
+  for (int slot = 0; slot < HT_BUCKET_SLOTS; slot++) {
+    if (bucket->slots[slot].key == NULL) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Zda skupina bucket leží na cestě od kroku step k jejímu začátku. Cesta
+ * nesmí skupinu navštívit dvakrát, jinak by se přesouval už přesunutý
+ * prvek.
+ */
+static bool ht_on_path(const ht_step_t steps[], int step, int bucket) {
+  for (; step >= 0; step = steps[step].parent) {
+    if (steps[step].bucket == bucket) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Uloží prvek item, jehož klíč v poli není a jehož první skupina je first,
+ * do pole buckets s mask + 1 skupinami. Vrací políčko s uloženým prvkem,
+ * nebo NULL, pokud se do HT_CUCKOO_SEARCH prohlédnutých skupin nenašla
+ * cesta k volnému políčku; pole pak zůstává beze změny.
+ */
+static ht_item_t *ht_place(ht_bucket_t *buckets, int mask,
+                           const ht_item_t *item, int first) {
+  ht_step_t steps[HT_CUCKOO_SEARCH];
+  steps[0] = (ht_step_t){.bucket = first, .parent = -1, .slot = -1};
+  steps[1] = (ht_step_t){.bucket = ht_other_bucket(first, item->tag, mask),
+                         .parent = -1,
+                         .slot = -1};
+  int queued = 2;
+  for (int at = 0; at < queued; at++) {
+    ht_item_t *slots = buckets[steps[at].bucket].slots;
+    int free_slot = ht_free_slot(&buckets[steps[at].bucket]);
+    if (free_slot >= 0) {
+      // přesuny od volného políčka zpět k začátku cesty
+      int step = at;
+      while (steps[step].parent >= 0) {
+        int parent = steps[step].parent;
+        buckets[steps[step].bucket].slots[free_slot] =
+            buckets[steps[parent].bucket].slots[steps[step].slot];
+        free_slot = steps[step].slot;
+        step = parent;
+      }
+      ht_item_t *slot = &buckets[steps[step].bucket].slots[free_slot];
+      *slot = *item;
+      return slot;
+    }
+    for (int slot = 0; slot < HT_BUCKET_SLOTS && queued < HT_CUCKOO_SEARCH;
+         slot++) {
+      int next = ht_other_bucket(steps[at].bucket, slots[slot].tag, mask);
+      if (!ht_on_path(steps, at, next)) {
+        steps[queued++] =
+            (ht_step_t){.bucket = next, .parent = at, .slot = slot};
+      }
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Přesune všechny prvky do nového pole s bucket_count skupinami. Hodnota
+ * rozptylovací funkce se pro každý klíč spočte znovu, protože prvek nese
+ * jen její dolní polovinu. Pokud se některý prvek nepodaří uložit, zkusí
+ * dvojnásobný počet skupin. Pokud se nepodaří alokovat nové pole, vrací
+ * false a tabulka zůstává beze změny.
+ */
+static bool ht_rehash(ht_table_t *table, int bucket_count) {
+  for (;;) {
+    ht_bucket_t *buckets =
+        aligned_alloc(HT_CACHE_LINE, bucket_count * sizeof(ht_bucket_t));
+    if (buckets == NULL) {
+      return false;
+    }
+    memset(buckets, 0, bucket_count * sizeof(ht_bucket_t));
+    int mask = bucket_count - 1;
+    bool placed = true;
+    for (int i = 0; table->buckets != NULL && placed && i < table->bucket_count;
+         i++) {
+      for (int slot = 0; placed && slot < HT_BUCKET_SLOTS; slot++) {
+        ht_item_t *item = &table->buckets[i].slots[slot];
+        if (item->key != NULL) {
+          uint32_t key_length;
+          uint64_t hash = ht_hash(item->key, table->seed, &key_length);
+          placed = ht_place(buckets, mask, item,
+                            ht_first_bucket(hash, mask)) != NULL;
+        }
+      }
+    }
+    if (placed) {
+      free(table->buckets);
+      table->buckets = buckets;
+      ht_set_buckets(table, bucket_count);
+      return true;
+    }
+    free(buckets);
+    if (bucket_count > INT_MAX / 2 / HT_BUCKET_SLOTS) {
+      return false;
+    }
+    bucket_count *= 2;
+  }
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ *
+ * Počáteční velikost tabulky je HT_DEFAULT_SIZE políček zaokrouhlená nahoru
+ * na celé skupiny, jejichž počet je mocnina dvou. Pole se alokuje až při
+ * prvním vložení prvku.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_size(table, HT_DEFAULT_SIZE);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí v políčkách,
+ * zaokrouhlenou jako v ht_init. Nekladná velikost znamená HT_DEFAULT_SIZE.
+ */
+void ht_init_size(ht_table_t *table, int size) {
+  if (table != NULL) {
+    int bucket_count = ht_round_buckets(size > 0 ? size : HT_DEFAULT_SIZE);
+    table->min_size = bucket_count * HT_BUCKET_SLOTS;
+    table->seed = ht_random_seed();
+    table->buckets = NULL;
+    table->count = 0;
+    ht_set_buckets(table, bucket_count);
+#ifdef HT_STATS
+    table->counters = (ht_counters_t){0};
+#endif
+  }
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  return ht_find(table, key, hash);
+}
+
+/*
+ * Vyhledání více klíčů najednou.
+ *
+ * Do results[i] zapíše prvek s klíčem keys[i], nebo NULL. Klíče se
+ * zpracovávají po HT_BATCH_WINDOW: nejprve se pro všechny spočte hodnota
+ * rozptylovací funkce a vyžádá se načtení obou jejich skupin, teprve pak se
+ * klíče hledají.
+ */
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]) {
+  uint64_t hashes[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    char **window = keys + start;
+    if (table == NULL || table->buckets == NULL) {
+      for (int i = 0; i < n; i++) {
+        results[start + i] = NULL;
+      }
+      continue;
+    }
+    int mask = table->bucket_count - 1;
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL) {
+        uint32_t key_length;
+        hashes[i] = ht_hash(window[i], table->seed, &key_length);
+        int first = ht_first_bucket(hashes[i], mask);
+        HT_PREFETCH(&table->buckets[first]);
+        HT_PREFETCH(&table->buckets[ht_other_bucket(
+            first, (uint32_t)hashes[i], mask)]);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      results[start + i] =
+          window[i] != NULL ? ht_find(table, window[i], hashes[i]) : NULL;
+    }
+  }
+}
+
+/*
+ * Získání hodnot více klíčů najednou.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Klíče vyhledá funkcí ht_search_batch.
+ */
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]) {
+  ht_item_t *items[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    ht_search_batch(table, keys + start, n, items);
+    for (int i = 0; i < n; i++) {
+      values[start + i] = items[i] != NULL ? &items[i]->value : NULL;
+    }
+  }
+}
+
+/*
+ * Uloží nový prvek s klíčem, o kterém volající ví, že v tabulce není.
+ * Pokud by počet prvků překročil HT_MAX_LOAD_FACTOR, nebo pokud se pro prvek
+ * nenajde cesta přesunů, tabulka se předtím zvětší. Vrací nový prvek, nebo
+ * NULL, pokud se nepodařilo alokovat paměť.
+ */
+static ht_item_t *ht_add(ht_table_t *table, char *key, uint64_t hash,
+                         float value) {
+  if (table->buckets == NULL && !ht_rehash(table, table->bucket_count)) {
+    return NULL;
+  }
+  if (table->count >= table->grow_at &&
+      (table->bucket_count > INT_MAX / 2 / HT_BUCKET_SLOTS ||
+       !ht_rehash(table, 2 * table->bucket_count))) {
+    return NULL;
+  }
+
+  ht_item_t item = {.key = key, .value = value, .tag = (uint32_t)hash};
+  ht_item_t *slot;
+  while ((slot = ht_place(table->buckets, table->bucket_count - 1, &item,
+                          ht_first_bucket(hash, table->bucket_count - 1))) ==
+         NULL) {
+    if (table->bucket_count > INT_MAX / 2 / HT_BUCKET_SLOTS ||
+        !ht_rehash(table, 2 * table->bucket_count)) {
+      return NULL;
+    }
+  }
+  table->count++;
+  HT_COUNT(table, inserts, 1);
+  return slot;
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahradí jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t *item = ht_find(table, key, hash);
+  if (item != NULL) {
+    item->value = value;
+  } else {
+    ht_add(table, key, hash, value);
+  }
+}
+
+/*
+ * Vložení mnoha prvků najednou.
+ *
+ * Vloží count dvojic items[i].key, items[i].value; pro stejné klíče platí
+ * hodnota poslední dvojice. Tabulka se předem jednou zvětší tak, aby se
+ * všechny dvojice vešly bez další změny velikosti, viz ht_swiss.c.
+ */
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  int needed = (table->count + (double)count) / HT_MAX_LOAD_FACTOR + 1;
+  if (needed > table->size && needed <= INT_MAX / 2) {
+    ht_rehash(table, ht_round_buckets(needed));
+  }
+  for (int i = 0; i < count; i++) {
+    ht_insert(table, items[i].key, items[i].value);
+  }
+}
+
+/*
+ * Vyhledání prvku, případně jeho vložení s hodnotou 0, jedinou operací.
+ * Viz ht_upsert v hashtable.c.
+ */
+float *ht_upsert(ht_table_t *table, char *key, bool *created) {
+  if (created != NULL) {
+    *created = false;
+  }
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t *item = ht_find(table, key, hash);
+  if (item != NULL) {
+    return &item->value;
+  }
+  item = ht_add(table, key, hash, 0);
+  if (item == NULL) {
+    return NULL;
+  }
+  if (created != NULL) {
+    *created = true;
+  }
+  return &item->value;
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *element = ht_search(table, key);
+  return element != NULL ? &element->value : NULL;
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Políčko se jen uvolní; ostatní prvky skupin se nepřesouvají, protože
+ * hledání nikdy nepokračuje za druhou skupinu klíče.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t *item = ht_find(table, key, hash);
+  if (item == NULL) {
+    return;
+  }
+  item->key = NULL;
+  table->count--;
+  HT_COUNT(table, deletes, 1);
+
+  if (table->count < table->shrink_at) {
+    int size = 2 * table->count > table->min_size ? 2 * table->count
+                                                  : table->min_size;
+    ht_rehash(table, ht_round_buckets(size));
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Funkce uvolní pole skupin a uvede tabulku do stavu po inicializaci.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  free(table->buckets);
+  table->buckets = NULL;
+  table->count = 0;
+  ht_set_buckets(table, table->min_size / HT_BUCKET_SLOTS);
+}
+
+/*
+ * Vyprázdnění tabulky pro další použití.
+ *
+ * Pole počáteční velikosti ponechá a jen uvolní všechna políčka; tabulku
+ * jiné velikosti uvolní jako ht_delete_all.
+ */
+void ht_clear(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  if (table->buckets == NULL || table->size != table->min_size) {
+    ht_delete_all(table);
+    return;
+  }
+  memset(table->buckets, 0, table->bucket_count * sizeof(ht_bucket_t));
+  table->count = 0;
+}
+
+/*
+ * Faktor naplnění tabulky, tedy podíl obsazených políček.
+ */
+float ht_load_factor(ht_table_t *table) {
+  if (table == NULL || table->size == 0) {
+    return 0;
+  }
+  return (float)table->count / table->size;
+}
+
+/*
+ * Zavolá visit(item, context) pro každý prvek tabulky. Funkce visit nesmí
+ * tabulku měnit.
+ */
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context) {
+  if (table == NULL || table->buckets == NULL) {
+    return;
+  }
+  for (int i = 0; i < table->bucket_count; i++) {
+    for (int slot = 0; slot < HT_BUCKET_SLOTS; slot++) {
+      if (table->buckets[i].slots[slot].key != NULL) {
+        visit(&table->buckets[i].slots[slot], context);
+      }
+    }
+  }
+}
+
+/*
+ * Zjistí stav tabulky do *stats. Histogram počítá prvky podle toho, zda
+ * leží v první (histogram[0]), nebo ve druhé skupině svého klíče
+ * (histogram[1]); max_chain je počet skupin, které prohlédne nejdelší
+ * hledání přítomného klíče. Hodnota rozptylovací funkce se pro každý klíč
+ * spočte znovu.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(ht_stats_t));
+  if (table == NULL) {
+    return;
+  }
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->count = table->count;
+  stats->size = table->size;
+  stats->load_factor = ht_load_factor(table);
+  int mask = table->bucket_count - 1;
+  for (int i = 0; table->buckets != NULL && i < table->bucket_count; i++) {
+    for (int slot = 0; slot < HT_BUCKET_SLOTS; slot++) {
+      ht_item_t *item = &table->buckets[i].slots[slot];
+      if (item->key == NULL) {
+        continue;
+      }
+      uint32_t key_length;
+      uint64_t hash = ht_hash(item->key, table->seed, &key_length);
+      int second = ht_first_bucket(hash, mask) != i;
+      stats->histogram[second]++;
+      if (second + 1 > stats->max_chain) {
+        stats->max_chain = second + 1;
+      }
+    }
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ * Typy tabuľky s kukučím rozptýlením do skupín políčok (ht_cuckoo.c).
+ * Súbor sa vkladá z hashtable.h pri preklade s -DHT_BACKEND_CUCKOO.
+ *
+ * Každý kľúč môže ležať len v jednej z dvoch skupín HT_BUCKET_SLOTS
+ * políčok, ktoré určia dve rozptyľovacie funkcie. Skupina zaberá práve
+ * jeden riadok vyrovnávacej pamäte, hľadanie teda prečíta najviac dva.
+ */
+
+#ifndef IAL_HASHTABLE_HT_CUCKOO_H
+#define IAL_HASHTABLE_HT_CUCKOO_H
+
+#define HT_CUCKOO
+#define HT_BACKEND_NAME "cuckoo"
+
+// Hranice faktoru naplnenia (podiel obsadených políčok)
+#define HT_MAX_LOAD_FACTOR 0.9
+#define HT_MIN_LOAD_FACTOR 0.125
+
+// Počet políčok v jednej skupine
+#define HT_BUCKET_SLOTS 4
+
+// Veľkosť riadku vyrovnávacej pamäte, na ktorú sú zarovnané skupiny
+#define HT_CACHE_LINE 64
+
+/*
+ * Najväčší počet skupín, ktoré vkladanie prezrie pri hľadaní cesty
+ * presunov k voľnému políčku. Ak ju nenájde, tabuľka sa zväčší.
+ */
+#define HT_CUCKOO_SEARCH 256
+
+/*
+ * Prvok tabuľky. Namiesto celej hodnoty rozptyľovacej funkcie sa ukladá len
+ * jej dolná polovica, aby sa skupina zmestila do riadku vyrovnávacej pamäte.
+ */
+typedef struct ht_item {
+  char *key;    // kľúč prvku, NULL pre prázdne políčko
+  float value;  // hodnota prvku
+  uint32_t tag; // dolných 32 bitov hodnoty rozptyľovacej funkcie kľúča
+} ht_item_t;
+
+// Skupina políčok v jednom riadku vyrovnávacej pamäte
+typedef struct ht_bucket {
+  _Alignas(HT_CACHE_LINE) ht_item_t slots[HT_BUCKET_SLOTS];
+} ht_bucket_t;
+
+// Tabuľka s kukučím rozptýlením
+typedef struct ht_table {
+  ht_bucket_t *buckets; // skupiny políčok, NULL pred prvým vložením
+  int bucket_count;     // počet skupín, mocnina dvoch aspoň 2
+  int size;             // počet políčok
+  int count;            // počet prvkov v tabuľke
+  int min_size;         // počiatočná a zároveň najmenšia veľkosť tabuľky
+  int grow_at;          // počet prvkov, pri ktorom sa tabuľka zväčší
+  int shrink_at;        // počet prvkov, pri ktorom sa tabuľka zmenší
+  uint64_t seed;        // semienko rozptyľovacej funkcie tejto tabuľky
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá volaní
+#endif
+} ht_table_t;
+
+#endif
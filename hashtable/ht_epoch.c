@@ -0,0 +1,155 @@
+/*
+ * Uvolňování paměti podle epoch
+ *
+ * Každé vlákno, které čte tabulku, má záznam se stavem: 0 mimo kritickou
+ * sekci, jinak (epocha << 1) | 1 s globální epochou platnou při vstupu.
+ * Globální epocha smí postoupit z E na E + 1 jen tehdy, když všechna vlákna
+ * v kritické sekci ohlásila E. Prvek odpojený v epoše E proto nemůže vidět
+ * žádné vlákno, jakmile globální epocha dosáhne E + 2.
+ *
+ * Záznamy tvoří seznam sdílený všemi tabulkami, do kterého se jen přidává.
+ * Záznam ukončeného vlákna se uvolní pro další vlákno.
+ */
+
+#include "ht_epoch.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Záznam jednoho vlákna, každý v samostatném řádku vyrovnávací paměti
+typedef struct ht_epoch_record {
+  _Alignas(64) _Atomic uint64_t state; // stav vlákna, viz výše
+  _Atomic bool in_use;                 // záznam patří živému vláknu
+  struct ht_epoch_record *next;        // další záznam seznamu
+  int depth;                           // hloubka vnoření kritických sekcí
+} ht_epoch_record_t;
+
+static _Atomic uint64_t ht_epoch_global = 1;
+static _Atomic(ht_epoch_record_t *) ht_epoch_records = NULL;
+static _Thread_local ht_epoch_record_t *ht_epoch_self = NULL;
+static pthread_key_t ht_epoch_key;
+static pthread_once_t ht_epoch_once = PTHREAD_ONCE_INIT;
+
+static void ht_epoch_release(void *record) {
+  atomic_store_explicit(&((ht_epoch_record_t *)record)->in_use, false,
+                        memory_order_release);
+}
+
+static void ht_epoch_init_key(void) {
+  pthread_key_create(&ht_epoch_key, ht_epoch_release);
+}
+
+/*
+ * Záznam volajícího vlákna. Při prvním volání převezme volný záznam, nebo
+ * přidá nový. Vrací NULL, pokud se záznam nepodařilo alokovat.
+ */
+static ht_epoch_record_t *ht_epoch_record(void) {
+  if (ht_epoch_self != NULL) {
+    return ht_epoch_self;
+  }
+  pthread_once(&ht_epoch_once, ht_epoch_init_key);
+  ht_epoch_record_t *record =
+      atomic_load_explicit(&ht_epoch_records, memory_order_acquire);
+  for (; record != NULL; record = record->next) {
+    bool expected = false;
+    if (atomic_compare_exchange_strong(&record->in_use, &expected, true)) {
+      break;
+    }
+  }
+  if (record == NULL) {
+    record = aligned_alloc(64, sizeof(ht_epoch_record_t));
+    if (record == NULL) {
+      return NULL;
+    }
+    atomic_init(&record->state, 0);
+    atomic_init(&record->in_use, true);
+    record->next = atomic_load(&ht_epoch_records);
+    while (!atomic_compare_exchange_weak(&ht_epoch_records, &record->next,
+                                         record)) {
+    }
+  }
+  record->depth = 0;
+  pthread_setspecific(ht_epoch_key, record);
+  ht_epoch_self = record;
+  return record;
+}
+
+/*
+ * Vstup do kritické sekce, ve které smí vlákno číst sdílené prvky bez
+ * zámků. Kritické sekce lze vnořovat. Vrací false, pokud se vláknu
+ * nepodařilo alokovat záznam; do kritické sekce pak nevstoupilo.
+ *
+ * Ohlášená epocha se po zveřejnění stavu ověří, aby vlákno neohlásilo
+ * epochu, kterou už mezitím ostatní opustili.
+ */
+bool ht_epoch_enter(void) {
+  ht_epoch_record_t *self = ht_epoch_record();
+  if (self == NULL) {
+    return false;
+  }
+  if (self->depth++ > 0) {
+    return true;
+  }
+  uint64_t epoch = atomic_load_explicit(&ht_epoch_global, memory_order_relaxed);
+  for (;;) {
+    atomic_store_explicit(&self->state, epoch << 1 | 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t now = atomic_load_explicit(&ht_epoch_global, memory_order_relaxed);
+    if (now == epoch) {
+      return true;
+    }
+    epoch = now;
+  }
+}
+
+/*
+ * Opuštění kritické sekce. Ukazatele přečtené uvnitř nesmí vlákno dál
+ * používat.
+ */
+void ht_epoch_leave(void) {
+  ht_epoch_record_t *self = ht_epoch_self;
+  if (--self->depth == 0) {
+    atomic_store_explicit(&self->state, 0, memory_order_release);
+  }
+}
+
+/*
+ * Aktuální globální epocha. Zapisovatel ji čte až po odpojení prvku;
+ * bariéra zajistí, že ji nepřečte dřív.
+ */
+uint64_t ht_epoch_current(void) {
+  atomic_thread_fence(memory_order_seq_cst);
+  return atomic_load_explicit(&ht_epoch_global, memory_order_relaxed);
+}
+
+/*
+ * Pokusí se posunout globální epochu o jedna. Vrací true, pokud epocha od
+ * začátku volání postoupila, ať už tímto, nebo jiným vláknem.
+ */
+bool ht_epoch_try_advance(void) {
+  uint64_t epoch = ht_epoch_current();
+  ht_epoch_record_t *record =
+      atomic_load_explicit(&ht_epoch_records, memory_order_acquire);
+  for (; record != NULL; record = record->next) {
+    uint64_t state = atomic_load_explicit(&record->state, memory_order_acquire);
+    if ((state & 1) && state >> 1 != epoch) {
+      return false;
+    }
+  }
+  atomic_compare_exchange_strong(&ht_epoch_global, &epoch, epoch + 1);
+  return true;
+}
+
+/*
+ * Počká, až globální epocha postoupí o dvě, takže všechny prvky odpojené
+ * před voláním lze uvolnit. Volající nesmí být v kritické sekci.
+ */
+void ht_epoch_synchronize(void) {
+  uint64_t target = ht_epoch_current() + 2;
+  while (ht_epoch_current() < target) {
+    if (!ht_epoch_try_advance()) {
+      sched_yield();
+    }
+  }
+}
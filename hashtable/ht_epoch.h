@@ -0,0 +1,25 @@
+/*
+ * Uvoľňovanie pamäte podľa epoch (ht_epoch.c) pre tabuľku so zámkami.
+ *
+ * Čitateľ prechádza tabuľku bez zámkov medzi ht_epoch_enter
+ * a ht_epoch_leave. Zapisovateľ prvok najprv odpojí a uvoľní ho až potom,
+ * keď sa globálna epocha od odpojenia posunie aspoň o dve; vtedy už žiadny
+ * čitateľ, ktorý mohol prvok vidieť, nie je v kritickej sekcii.
+ */
+
+#ifndef IAL_HASHTABLE_HT_EPOCH_H
+#define IAL_HASHTABLE_HT_EPOCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Počet epoch, ktorých odložené prvky sa držia naraz
+#define HT_EPOCHS 3
+
+bool ht_epoch_enter(void);
+void ht_epoch_leave(void);
+uint64_t ht_epoch_current(void);
+bool ht_epoch_try_advance(void);
+void ht_epoch_synchronize(void);
+
+#endif
@@ -0,0 +1,464 @@
+/*
+ * Zmrazená tabulka s minimálním dokonalým rozptýlením
+ *
+ * Zmrazení rozdělí klíče do skupin podle horních 32 bitů hodnoty
+ * rozptylovací funkce a skupiny od největší umisťuje na pozice tabulky.
+ * Pro každou skupinu zkouší posuny 0, 1, 2, ..., dokud všechny její klíče
+ * nepadnou na různé volné pozice, a nalezený posun si uloží. Hledání pak
+ * spočítá pozici klíče z hodnoty rozptylovací funkce a posunu jeho skupiny
+ * a porovná jediný uložený klíč.
+ *
+ * Posun se hledá mezi slots > count pozicemi, takže i poslední skupiny
+ * najdou volné místo po několika pokusech. Klíče, které padnou na pozici
+ * count nebo vyšší, se nakonec přesměrují na zbylé volné pozice pod count,
+ * hodnoty i klíče tedy leží v polích přesně o count prvcích.
+ *
+ * Blok dat má tvar:
+ *
+ *   hlavička | pilots | remap | values | offsets | keys
+ *
+ * a každý úsek začíná na násobku osmi bytů. Uvnitř bloku nejsou ukazatele,
+ * soubor je tedy přesnou kopií bloku.
+ */
+
+#include "ht_frozen.h"
+#include "ht_hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Začátek souboru se zmrazenou tabulkou a verze jeho tvaru
+#define HT_FROZEN_MAGIC "HTFZ"
+#define HT_FROZEN_VERSION 1
+
+/*
+ * Počet pokusů o zmrazení. Nenajde-li některá skupina posun (nejspíš kvůli
+ * dvěma klíčům se stejnou hodnotou rozptylovací funkce), zkusí se jiné
+ * semínko.
+ */
+#define HT_FROZEN_ATTEMPTS 16
+
+// Počet různých posunů skupiny, které se vejdou do uint16_t
+#define HT_FROZEN_PILOTS 65536
+
+// Hlavička bloku dat
+typedef struct ht_frozen_header {
+  char magic[4];         // HT_FROZEN_MAGIC
+  uint32_t version;      // HT_FROZEN_VERSION
+  uint32_t count;        // počet prvků
+  uint32_t slots;        // počet pozic při hledání posunů
+  uint32_t bucket_count; // počet skupin klíčů
+  uint32_t reserved;     // nulové zarovnání
+  uint64_t seed;         // semínko rozptylovací funkce
+  uint64_t size;         // velikost celého bloku v bytech
+} ht_frozen_header_t;
+
+// Klíč zmrazované tabulky
+typedef struct ht_frozen_key {
+  char *key;           // klíč prvku
+  float value;         // hodnota prvku
+  uint32_t key_length; // délka klíče bez ukončovací nuly
+  uint64_t hash;       // hodnota rozptylovací funkce pro aktuální semínko
+  uint32_t slot;       // přidělená pozice
+} ht_frozen_key_t;
+
+// Klíče posbírané z tabulky funkcí ht_foreach
+typedef struct ht_frozen_keys {
+  ht_frozen_key_t *keys; // pole klíčů
+  int count;             // počet posbíraných klíčů
+  int capacity;          // velikost pole keys
+} ht_frozen_keys_t;
+
+static inline size_t ht_align8(size_t size) {
+  return (size + 7) & ~(size_t)7;
+}
+
+/*
+ * Skupina klíče pro hodnotu rozptylovací funkce hash.
+ */
+static inline uint32_t ht_frozen_bucket(uint64_t hash, uint32_t bucket_count) {
+  return ((hash >> 32) * bucket_count) >> 32;
+}
+
+/*
+ * Pozice klíče s hodnotou rozptylovací funkce hash ve skupině s posunem
+ * pilot. Promíchání zajistí, že pozice nezávisí na skupině a že různé posuny
+ * dávají nezávislé pozice.
+ */
+static inline uint32_t ht_frozen_slot(uint64_t hash, uint16_t pilot,
+                                      uint32_t slots) {
+  uint64_t mixed = ht_avalanche(hash ^ (pilot + 1) * HT_PRIME_4);
+  return ((mixed >> 32) * slots) >> 32;
+}
+
+/*
+ * Rozmístí úseky bloku data podle hlavičky na jeho začátku a nastaví
+ * ukazatele ve frozen. Vrací velikost bloku, kterou hlavička vyžaduje.
+ */
+static size_t ht_frozen_map(ht_frozen_t *frozen, void *data) {
+  const ht_frozen_header_t *header = data;
+  char *next = data;
+  size_t offset = ht_align8(sizeof(ht_frozen_header_t));
+  size_t pilots = offset;
+  offset += ht_align8((size_t)header->bucket_count * sizeof(uint16_t));
+  size_t remap = offset;
+  offset +=
+      ht_align8((size_t)(header->slots - header->count) * sizeof(uint32_t));
+  size_t values = offset;
+  offset += ht_align8((size_t)header->count * sizeof(float));
+  size_t offsets = offset;
+  offset += ht_align8(((size_t)header->count + 1) * sizeof(uint32_t));
+  size_t keys = offset;
+
+  frozen->data = data;
+  frozen->count = header->count;
+  frozen->slots = header->slots;
+  frozen->bucket_count = header->bucket_count;
+  frozen->seed = header->seed;
+  frozen->pilots = (const uint16_t *)(next + pilots);
+  frozen->remap = (const uint32_t *)(next + remap);
+  frozen->values = (float *)(next + values);
+  frozen->offsets = (const uint32_t *)(next + offsets);
+  frozen->keys = next + keys;
+  return keys;
+}
+
+static void ht_frozen_collect(ht_item_t *item, void *context) {
+  ht_frozen_keys_t *keys = context;
+  if (keys->count == keys->capacity) {
+    return;
+  }
+  keys->keys[keys->count].key = item->key;
+  keys->keys[keys->count].value = item->value;
+  keys->count++;
+}
+
+static void ht_frozen_count(ht_item_t *item, void *context) {
+  (void)item;
+  (*(int *)context)++;
+}
+
+/*
+ * Najde posuny všech skupin a každému klíči přidělí pozici pod slots. Pole
+ * order obsahuje indexy klíčů seřazené podle skupiny a hashes jejich hodnoty
+ * rozptylovací funkce v témže pořadí, aby zkoušení posunů četlo souvislou
+ * paměť. bucket_start[b] je index prvního klíče skupiny b v order a by_size
+ * obsahuje skupiny sestupně podle velikosti. Vrací false, pokud některá
+ * skupina posun nenašla.
+ */
+static bool ht_frozen_place(ht_frozen_key_t *keys, const uint32_t *order,
+                            const uint64_t *hashes,
+                            const uint32_t *bucket_start,
+                            const uint32_t *by_size, uint32_t bucket_count,
+                            uint32_t slots, uint16_t *pilots,
+                            uint64_t *taken, uint32_t *candidates) {
+  for (uint32_t i = 0; i < bucket_count; i++) {
+    uint32_t bucket = by_size[i];
+    uint32_t first = bucket_start[bucket];
+    uint32_t size = bucket_start[bucket + 1] - first;
+    if (size == 0) {
+      break;
+    }
+    bool placed = false;
+    for (uint32_t pilot = 0; pilot < HT_FROZEN_PILOTS && !placed; pilot++) {
+      placed = true;
+      for (uint32_t k = 0; k < size && placed; k++) {
+        uint32_t slot = ht_frozen_slot(hashes[first + k], pilot, slots);
+        if (taken[slot / 64] & (1ULL << (slot % 64))) {
+          placed = false;
+        }
+        for (uint32_t j = 0; j < k && placed; j++) {
+          placed = candidates[j] != slot;
+        }
+        candidates[k] = slot;
+      }
+      if (placed) {
+        pilots[bucket] = pilot;
+      }
+    }
+    if (!placed) {
+      return false;
+    }
+    for (uint32_t k = 0; k < size; k++) {
+      taken[candidates[k] / 64] |= 1ULL << (candidates[k] % 64);
+      keys[order[first + k]].slot = candidates[k];
+    }
+  }
+  return true;
+}
+
+/*
+ * Zmrazí klíče keys[0] až keys[count - 1] do frozen. Vrací false, pokud se
+ * nepodařilo alokovat paměť nebo najít posuny pro žádné ze semínek.
+ */
+static bool ht_frozen_build(ht_frozen_t *frozen, ht_frozen_key_t *keys,
+                            uint32_t count) {
+  uint32_t slots = count + count / HT_FROZEN_SLACK + 1;
+  uint32_t bucket_count = count / HT_FROZEN_BUCKET_SIZE + 1;
+  size_t words = (slots + 63) / 64;
+  uint32_t *order = malloc(((size_t)count + 1) * sizeof(uint32_t));
+  uint64_t *hashes = malloc(((size_t)count + 1) * sizeof(uint64_t));
+  uint32_t *bucket_start =
+      malloc(((size_t)bucket_count + 2) * sizeof(uint32_t));
+  uint32_t *by_size = malloc((size_t)bucket_count * sizeof(uint32_t));
+  uint32_t *sizes = malloc(((size_t)count + 2) * sizeof(uint32_t));
+  uint32_t *candidates = malloc(((size_t)count + 1) * sizeof(uint32_t));
+  // prázdným skupinám ht_frozen_place posun nenastaví, v souboru bude 0
+  uint16_t *pilots = calloc(bucket_count, sizeof(uint16_t));
+  uint64_t *taken = malloc(words * sizeof(uint64_t));
+  bool placed = false;
+  uint64_t seed = ht_random_seed();
+
+  if (order != NULL && hashes != NULL && bucket_start != NULL &&
+      by_size != NULL && sizes != NULL && candidates != NULL &&
+      pilots != NULL && taken != NULL) {
+    for (int attempt = 0; attempt < HT_FROZEN_ATTEMPTS && !placed; attempt++) {
+      if (attempt > 0) {
+        seed = ht_avalanche(seed + HT_PRIME_5);
+      }
+      // klíče seřazené podle skupiny počítáním
+      memset(bucket_start, 0, ((size_t)bucket_count + 2) * sizeof(uint32_t));
+      for (uint32_t i = 0; i < count; i++) {
+        keys[i].hash = ht_hash(keys[i].key, seed, &keys[i].key_length);
+        bucket_start[ht_frozen_bucket(keys[i].hash, bucket_count) + 2]++;
+      }
+      for (uint32_t b = 0; b < bucket_count; b++) {
+        bucket_start[b + 2] += bucket_start[b + 1];
+      }
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t bucket = ht_frozen_bucket(keys[i].hash, bucket_count);
+        hashes[bucket_start[bucket + 1]] = keys[i].hash;
+        order[bucket_start[bucket + 1]++] = i;
+      }
+      // skupiny seřazené sestupně podle velikosti, opět počítáním
+      memset(sizes, 0, ((size_t)count + 2) * sizeof(uint32_t));
+      for (uint32_t b = 0; b < bucket_count; b++) {
+        sizes[count - (bucket_start[b + 1] - bucket_start[b]) + 1]++;
+      }
+      for (uint32_t s = 0; s <= count; s++) {
+        sizes[s + 1] += sizes[s];
+      }
+      for (uint32_t b = 0; b < bucket_count; b++) {
+        by_size[sizes[count - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+      }
+      memset(taken, 0, words * sizeof(uint64_t));
+      placed = ht_frozen_place(keys, order, hashes, bucket_start, by_size,
+                               bucket_count, slots, pilots, taken, candidates);
+    }
+  }
+
+  void *data = NULL;
+  if (placed) {
+    size_t key_bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      key_bytes += keys[i].key_length + 1;
+    }
+    ht_frozen_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HT_FROZEN_MAGIC, sizeof(header.magic));
+    header.version = HT_FROZEN_VERSION;
+    header.count = count;
+    header.slots = slots;
+    header.bucket_count = bucket_count;
+    header.seed = seed;
+    header.size = ht_align8(ht_frozen_map(frozen, &header) + key_bytes);
+    if (key_bytes <= UINT32_MAX) {
+      data = calloc(1, header.size);
+    }
+    if (data != NULL) {
+      memcpy(data, &header, sizeof(header));
+      ht_frozen_map(frozen, data);
+      frozen->data_size = header.size;
+    }
+  }
+  if (data != NULL) {
+    memcpy((uint16_t *)frozen->pilots, pilots,
+           (size_t)bucket_count * sizeof(uint16_t));
+    // pozice nad count se přesměrují na volné pozice pod count
+    uint32_t *remap = (uint32_t *)frozen->remap;
+    uint32_t free_slot = 0;
+    for (uint32_t slot = count; slot < slots; slot++) {
+      if (taken[slot / 64] & (1ULL << (slot % 64))) {
+        while (taken[free_slot / 64] & (1ULL << (free_slot % 64))) {
+          free_slot++;
+        }
+        remap[slot - count] = free_slot++;
+      }
+    }
+    // klíče a hodnoty podle pozice; order poslouží jako index klíče pozice
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t slot = keys[i].slot;
+      order[slot < count ? slot : remap[slot - count]] = i;
+    }
+    uint32_t *offsets = (uint32_t *)frozen->offsets;
+    char *stored = (char *)frozen->keys;
+    uint32_t offset = 0;
+    for (uint32_t slot = 0; slot < count; slot++) {
+      ht_frozen_key_t *key = &keys[order[slot]];
+      offsets[slot] = offset;
+      frozen->values[slot] = key->value;
+      memcpy(stored + offset, key->key, key->key_length + 1);
+      offset += key->key_length + 1;
+    }
+    offsets[count] = offset;
+  }
+
+  free(order);
+  free(hashes);
+  free(bucket_start);
+  free(by_size);
+  free(sizes);
+  free(candidates);
+  free(pilots);
+  free(taken);
+  return data != NULL;
+}
+
+/*
+ * Vytvoří z prvků tabulky table zmrazenou tabulku frozen. Zmrazená tabulka
+ * si klíče kopíruje a na table dál nezávisí. Vrací false, pokud se
+ * nepodařilo alokovat paměť; frozen pak nic nedrží.
+ */
+bool ht_freeze(ht_table_t *table, ht_frozen_t *frozen) {
+  ht_frozen_keys_t keys = {NULL, 0, 0};
+  memset(frozen, 0, sizeof(ht_frozen_t));
+  ht_foreach(table, ht_frozen_count, &keys.capacity);
+  keys.keys = malloc(((size_t)keys.capacity + 1) * sizeof(ht_frozen_key_t));
+  if (keys.keys == NULL) {
+    return false;
+  }
+  ht_foreach(table, ht_frozen_collect, &keys);
+  bool built = ht_frozen_build(frozen, keys.keys, keys.count);
+  free(keys.keys);
+  if (!built) {
+    memset(frozen, 0, sizeof(ht_frozen_t));
+  }
+  return built;
+}
+
+/*
+ * Vrátí ukazatel na hodnotu klíče key, nebo NULL, pokud klíč ve zmrazené
+ * tabulce není. Hodnotu lze přes ukazatel měnit, klíče ne.
+ */
+float *ht_frozen_get(const ht_frozen_t *frozen, char *key) {
+  if (frozen->count == 0) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, frozen->seed, &key_length);
+  uint16_t pilot =
+      frozen->pilots[ht_frozen_bucket(hash, frozen->bucket_count)];
+  uint32_t slot = ht_frozen_slot(hash, pilot, frozen->slots);
+  if (slot >= (uint32_t)frozen->count) {
+    slot = frozen->remap[slot - frozen->count];
+  }
+  uint32_t start = frozen->offsets[slot];
+  if (frozen->offsets[slot + 1] - start != key_length + 1 ||
+      memcmp(frozen->keys + start, key, key_length) != 0) {
+    return NULL;
+  }
+  return &frozen->values[slot];
+}
+
+/*
+ * Zapíše zmrazenou tabulku do souboru path. Vrací false při chybě zápisu.
+ */
+bool ht_frozen_save(const ht_frozen_t *frozen, const char *path) {
+  if (frozen->data == NULL) {
+    return false;
+  }
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+  bool written = fwrite(frozen->data, 1, frozen->data_size, file) ==
+                 frozen->data_size;
+  return fclose(file) == 0 && written;
+}
+
+/*
+ * Ověří hlavičku souboru délky file_size ještě před alokací bloku: blok se
+ * všemi poli, jejichž rozměry hlavička udává, musí vyplnit právě celý soubor.
+ */
+static bool ht_frozen_check_header(ht_frozen_header_t *header,
+                                   long file_size) {
+  ht_frozen_t frozen;
+  if (memcmp(header->magic, HT_FROZEN_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != HT_FROZEN_VERSION || header->count > INT32_MAX ||
+      header->slots <= header->count || header->slots > INT32_MAX ||
+      header->bucket_count == 0) {
+    return false;
+  }
+  return file_size >= 0 && header->size == (uint64_t)file_size &&
+         header->size >= ht_frozen_map(&frozen, header);
+}
+
+/*
+ * Ověří, že pole načteného bloku ve frozen popisují platnou tabulku, takže
+ * hledání nikdy nesáhne mimo blok.
+ */
+static bool ht_frozen_check(const ht_frozen_t *frozen) {
+  // prázdná tabulka pole remap nepoužívá
+  for (int i = 0; frozen->count > 0 && i < frozen->slots - frozen->count;
+       i++) {
+    if (frozen->remap[i] >= (uint32_t)frozen->count) {
+      return false;
+    }
+  }
+  for (int i = 0; i < frozen->count; i++) {
+    if (frozen->offsets[i + 1] <= frozen->offsets[i]) {
+      return false;
+    }
+  }
+  return frozen->keys + frozen->offsets[frozen->count] <=
+         (const char *)frozen->data + frozen->data_size;
+}
+
+/*
+ * Načte do frozen tabulku zapsanou funkcí ht_frozen_save. Celý blok se
+ * přečte jedním voláním fread a ukazatele se jen nastaví do něj, žádná
+ * pole se nepřepočítávají. Vrací false, pokud soubor nejde přečíst nebo
+ * neobsahuje platnou zmrazenou tabulku; frozen pak nic nedrží.
+ */
+bool ht_frozen_load(ht_frozen_t *frozen, const char *path) {
+  ht_frozen_header_t header;
+  void *data = NULL;
+  memset(frozen, 0, sizeof(ht_frozen_t));
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  long file_size = -1;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    file_size = ftell(file);
+    rewind(file);
+  }
+  if (fread(&header, sizeof(header), 1, file) == 1 &&
+      ht_frozen_check_header(&header, file_size)) {
+    data = malloc(header.size);
+  }
+  if (data != NULL) {
+    size_t rest = header.size - sizeof(header);
+    memcpy(data, &header, sizeof(header));
+    ht_frozen_map(frozen, data);
+    frozen->data_size = header.size;
+    if (fread((char *)data + sizeof(header), 1, rest, file) != rest ||
+        !ht_frozen_check(frozen)) {
+      free(data);
+      data = NULL;
+    }
+  }
+  fclose(file);
+  if (data == NULL) {
+    memset(frozen, 0, sizeof(ht_frozen_t));
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Uvolní paměť zmrazené tabulky. Struktura frozen pak nic nedrží.
+ */
+void ht_frozen_free(ht_frozen_t *frozen) {
+  free(frozen->data);
+  memset(frozen, 0, sizeof(ht_frozen_t));
+}
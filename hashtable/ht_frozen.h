@@ -0,0 +1,58 @@
+/*
+ * Zmrazená tabuľka s minimálnym dokonalým rozptýlením (ht_frozen.c).
+ *
+ * Funkcia ht_freeze prevedie naplnenú tabuľku ľubovoľnej implementácie na
+ * nemennú tabuľku, v ktorej má každý z jej count kľúčov vlastnú pozíciu
+ * 0 až count - 1. Hodnoty ležia v súvislom poli podľa pozície a hľadanie
+ * porovná len jeden uložený kľúč. Kľúče sa rozdelia do skupín podľa
+ * rozptyľovacej funkcie a pre každú skupinu sa pri zmrazení nájde posun
+ * (pilot), pri ktorom jej kľúče padnú na voľné pozície.
+ *
+ * Celá tabuľka leží v jednom bloku pamäte bez ukazovateľov, ktorý
+ * ht_frozen_save zapíše do súboru a ht_frozen_load načíta jedným čítaním.
+ * Súbor je v poradí bytov počítača, ktorý ho zapísal.
+ */
+
+#ifndef IAL_HASHTABLE_HT_FROZEN_H
+#define IAL_HASHTABLE_HT_FROZEN_H
+
+#include "hashtable.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Priemerný počet kľúčov v jednej skupine
+#define HT_FROZEN_BUCKET_SIZE 4
+
+/*
+ * Nad count pozícií sa pri hľadaní posunov použije ešte count /
+ * HT_FROZEN_SLACK + 1 pozícií navyše, aby aj posledné skupiny rýchlo našli
+ * voľné miesto. Kľúče, ktoré na ne padnú, sa potom presmerujú na zostávajúce
+ * voľné pozície pod count.
+ */
+#define HT_FROZEN_SLACK 16
+
+// Zmrazená tabuľka
+typedef struct ht_frozen {
+  void *data;              // blok s hlavičkou a poľami nižšie, v rovnakej
+                           // podobe ako v súbore; NULL pre prázdnu štruktúru
+  size_t data_size;        // veľkosť bloku data v bytoch
+  int count;               // počet prvkov
+  int slots;               // počet pozícií pri hľadaní posunov
+  int bucket_count;        // počet skupín kľúčov
+  uint64_t seed;           // semienko rozptyľovacej funkcie
+  const uint16_t *pilots;  // posun každej skupiny
+  const uint32_t *remap;   // pozícia pod count pre pozície count až slots - 1
+  float *values;           // hodnoty podľa pozície kľúča
+  const uint32_t *offsets; // začiatok kľúča na pozícii i v poli keys,
+                           // offsets[count] je veľkosť poľa keys
+  const char *keys;        // kľúče s ukončovacou nulou podľa pozície
+} ht_frozen_t;
+
+bool ht_freeze(ht_table_t *table, ht_frozen_t *frozen);
+float *ht_frozen_get(const ht_frozen_t *frozen, char *key);
+bool ht_frozen_save(const ht_frozen_t *frozen, const char *path);
+bool ht_frozen_load(ht_frozen_t *frozen, const char *path);
+void ht_frozen_free(ht_frozen_t *frozen);
+
+#endif
@@ -0,0 +1,9 @@
+/*
+ * Tabulky s celočíselnými a s řetězcovými klíči a hodnotami typu double.
+ * Podrobnější popis tabulek vygenerovaných makrem HTDEF v ht_generic.h.
+ */
+
+#include "ht_generic.h"
+
+HTDEF(uint64_t, double, u64, ht_hash_u64, ht_eq_u64)
+HTDEF(char *, double, str, ht_hash_str, ht_eq_str)
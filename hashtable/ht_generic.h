@@ -0,0 +1,341 @@
+/*
+ * Tabuľka s rozptýlenými položkami pre ľubovoľný typ kľúča a hodnoty.
+ *
+ * Tabuľka z hashtable.h má kľúče typu char * a hodnoty typu float. Makrá
+ * HTDEC a HTDEF podobne ako STACKDEC a STACKDEF v btree/iter/stack.h
+ * vygenerujú tabuľku pre kľúč typu K a hodnotu typu V, ktorej funkcie majú
+ * rozptyľovaciu funkciu HASH a porovnanie EQ vložené priamo do kódu.
+ * Celočíselné kľúče tak netreba prevádzať na reťazce.
+ *
+ * HTDEC(K, V, NAME, HASH, EQ) vygeneruje deklarácie (do hlavičkového
+ * súboru), HTDEF(K, V, NAME, HASH, EQ) definície funkcií (do práve jedného
+ * zdrojového súboru). Pre NAME=u64, K=uint64_t, V=double:
+ *   Dátové typy ht_u64_item_t (položky key a value), ht_u64_t
+ *               a ht_u64_visit_t
+ *   Funkcie void ht_u64_init(ht_u64_t *table)
+ *           void ht_u64_init_size(ht_u64_t *table, int size)
+ *           ht_u64_item_t *ht_u64_search(ht_u64_t *table, uint64_t key)
+ *           double *ht_u64_get(ht_u64_t *table, uint64_t key)
+ *           void ht_u64_insert(ht_u64_t *table, uint64_t key, double value)
+ *           double *ht_u64_upsert(ht_u64_t *table, uint64_t key,
+ *                                 bool *created)
+ *           void ht_u64_delete(ht_u64_t *table, uint64_t key)
+ *           void ht_u64_delete_all(ht_u64_t *table)
+ *           void ht_u64_foreach(ht_u64_t *table, ht_u64_visit_t visit,
+ *                               void *context)
+ * ktoré sa správajú ako rovnomenné funkcie ht_* z hashtable.h.
+ *
+ * HASH(key, seed) vráti 64-bitovú hodnotu rozptyľovacej funkcie kľúča pre
+ * semienko tabuľky, EQ(a, b) vráti true pre rovnaké kľúče. Kľúče sa do
+ * tabuľky kopírujú ako hodnoty typu K; ukazovateľ v kľúči (napr. reťazec)
+ * musí volajúci udržiavať platný.
+ *
+ * Tabuľka má otvorené adresovanie podľa Robin Hood ako ht_robin.c, prvky
+ * však neukladajú hodnotu rozptyľovacej funkcie, aby boli čo najmenšie;
+ * pri zmene veľkosti sa kľúče rozptýlia znova.
+ */
+
+#ifndef IAL_HASHTABLE_HT_GENERIC_H
+#define IAL_HASHTABLE_HT_GENERIC_H
+
+#include "ht_hash.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Počiatočná veľkosť tabuľky, ktorú použije ht_NAME_init
+#define HT_GENERIC_DEFAULT_SIZE 128
+
+// Najmenšia veľkosť poľa
+#define HT_GENERIC_MIN_SIZE 8
+
+// Hranice faktoru naplnenia, ako pri ht_robin.h
+#define HT_GENERIC_MAX_LOAD_FACTOR 0.9
+#define HT_GENERIC_MIN_LOAD_FACTOR 0.125
+
+// Najväčšia vzdialenosť prvku od domovského políčka, viz ht_robin.h
+#define HT_GENERIC_MAX_DISTANCE 254
+
+// Rozptyľovacia funkcia a porovnanie celočíselných kľúčov
+static inline uint64_t ht_hash_u64(uint64_t key, uint64_t seed) {
+  return ht_avalanche(key ^ seed);
+}
+
+static inline bool ht_eq_u64(uint64_t a, uint64_t b) { return a == b; }
+
+// Rozptyľovacia funkcia a porovnanie reťazcov, ako v hashtable.h
+static inline uint64_t ht_hash_str(char *key, uint64_t seed) {
+  uint32_t key_length;
+  return ht_hash(key, seed, &key_length);
+}
+
+static inline bool ht_eq_str(char *a, char *b) { return strcmp(a, b) == 0; }
+
+// Domovské políčko v poli veľkosti mask + 1
+static inline int ht_generic_home(uint64_t hash, int mask) {
+  return (int)(hash >> 32) & mask;
+}
+
+// Najmenšia mocnina dvoch väčšia alebo rovná n, aspoň HT_GENERIC_MIN_SIZE
+static inline int ht_generic_round_size(int n) {
+  int size = HT_GENERIC_MIN_SIZE;
+  while (size < n && size <= INT_MAX / 2) {
+    size *= 2;
+  }
+  return size;
+}
+
+/*
+ * Makro generujúce deklarácie tabuľky s kľúčmi typu K a hodnotami typu V
+ * s názvovým infixom NAME. HASH a EQ sa nepoužijú, makro ich prijíma, aby
+ * malo rovnaké parametre ako HTDEF.
+ */
+#define HTDEC(K, V, NAME, HASH, EQ)                                            \
+  typedef struct {                                                             \
+    K key;                                                                     \
+    V value;                                                                   \
+  } ht_##NAME##_item_t;                                                        \
+                                                                               \
+  typedef struct {                                                             \
+    uint8_t *distances;                                                        \
+    ht_##NAME##_item_t *items;                                                 \
+    int size;                                                                  \
+    int count;                                                                 \
+    int min_size;                                                              \
+    int grow_at;                                                               \
+    int shrink_at;                                                             \
+    uint64_t seed;                                                             \
+  } ht_##NAME##_t;                                                             \
+                                                                               \
+  typedef void (*ht_##NAME##_visit_t)(ht_##NAME##_item_t * item,               \
+                                      void *context);                          \
+                                                                               \
+  void ht_##NAME##_init(ht_##NAME##_t *table);                                 \
+  void ht_##NAME##_init_size(ht_##NAME##_t *table, int size);                  \
+  ht_##NAME##_item_t *ht_##NAME##_search(ht_##NAME##_t *table, K key);         \
+  V *ht_##NAME##_get(ht_##NAME##_t *table, K key);                             \
+  void ht_##NAME##_insert(ht_##NAME##_t *table, K key, V value);               \
+  V *ht_##NAME##_upsert(ht_##NAME##_t *table, K key, bool *created);           \
+  void ht_##NAME##_delete(ht_##NAME##_t *table, K key);                        \
+  void ht_##NAME##_delete_all(ht_##NAME##_t *table);                           \
+  void ht_##NAME##_foreach(ht_##NAME##_t *table, ht_##NAME##_visit_t visit,    \
+                           void *context);
+
+/*
+ * Makro generujúce definície funkcií tabuľky deklarovanej makrom HTDEC
+ * s rovnakými parametrami. Pomocné funkcie sú statické, HTDEF pre jedno
+ * NAME teda patrí do jediného zdrojového súboru. Význam pomocných funkcií
+ * je rovnaký ako pri rovnomenných funkciách v ht_robin.c.
+ */
+#define HTDEF(K, V, NAME, HASH, EQ)                                            \
+  static void ht_##NAME##_set_size(ht_##NAME##_t *table, int size) {           \
+    table->size = size;                                                        \
+    table->grow_at = size * HT_GENERIC_MAX_LOAD_FACTOR;                        \
+    table->shrink_at =                                                         \
+        size > table->min_size ? size * HT_GENERIC_MIN_LOAD_FACTOR : 0;        \
+  }                                                                            \
+                                                                               \
+  static int ht_##NAME##_probe(ht_##NAME##_t *table, K key, uint64_t hash) {   \
+    if (table->distances == NULL) {                                            \
+      return -1;                                                               \
+    }                                                                          \
+    int mask = table->size - 1;                                                \
+    int index = ht_generic_home(hash, mask);                                   \
+    for (int distance = 1;; distance++) {                                      \
+      int stored = table->distances[index];                                    \
+      if (stored < distance) {                                                 \
+        return -1;                                                             \
+      }                                                                        \
+      if (stored == distance && EQ(table->items[index].key, key)) {            \
+        return index;                                                          \
+      }                                                                        \
+      index = (index + 1) & mask;                                              \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static int ht_##NAME##_place(uint8_t *distances, ht_##NAME##_item_t *items,  \
+                               int size, const ht_##NAME##_item_t *item,       \
+                               uint64_t hash) {                                \
+    int mask = size - 1;                                                       \
+    int index = ht_generic_home(hash, mask);                                   \
+    int distance = 1;                                                          \
+    while (distances[index] >= distance) {                                     \
+      index = (index + 1) & mask;                                              \
+      distance++;                                                              \
+    }                                                                          \
+    if (distance > HT_GENERIC_MAX_DISTANCE + 1) {                              \
+      return -1;                                                               \
+    }                                                                          \
+    int end = index;                                                           \
+    while (distances[end] != 0) {                                              \
+      if (distances[end] == HT_GENERIC_MAX_DISTANCE + 1) {                     \
+        return -1;                                                             \
+      }                                                                        \
+      end = (end + 1) & mask;                                                  \
+    }                                                                          \
+    while (end != index) {                                                     \
+      int previous = (end - 1) & mask;                                         \
+      items[end] = items[previous];                                            \
+      distances[end] = distances[previous] + 1;                                \
+      end = previous;                                                          \
+    }                                                                          \
+    items[index] = *item;                                                      \
+    distances[index] = distance;                                               \
+    return index;                                                              \
+  }                                                                            \
+                                                                               \
+  static bool ht_##NAME##_rehash(ht_##NAME##_t *table, int size) {             \
+    for (;;) {                                                                 \
+      uint8_t *distances = calloc(size, sizeof(uint8_t));                      \
+      ht_##NAME##_item_t *items = malloc(size * sizeof(ht_##NAME##_item_t));   \
+      if (distances == NULL || items == NULL) {                                \
+        free(distances);                                                       \
+        free(items);                                                           \
+        return false;                                                          \
+      }                                                                        \
+      bool placed = true;                                                      \
+      for (int i = 0; table->distances != NULL && placed && i < table->size;   \
+           i++) {                                                              \
+        if (table->distances[i] != 0) {                                        \
+          uint64_t hash = HASH(table->items[i].key, table->seed);              \
+          placed = ht_##NAME##_place(distances, items, size,                   \
+                                     &table->items[i], hash) >= 0;             \
+        }                                                                      \
+      }                                                                        \
+      if (placed) {                                                            \
+        free(table->distances);                                                \
+        free(table->items);                                                    \
+        table->distances = distances;                                          \
+        table->items = items;                                                  \
+        ht_##NAME##_set_size(table, size);                                     \
+        return true;                                                           \
+      }                                                                        \
+      free(distances);                                                         \
+      free(items);                                                             \
+      if (size > INT_MAX / 2) {                                                \
+        return false;                                                          \
+      }                                                                        \
+      size *= 2;                                                               \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static ht_##NAME##_item_t *ht_##NAME##_add(ht_##NAME##_t *table, K key,      \
+                                             uint64_t hash, V value) {         \
+    if (table->distances == NULL && !ht_##NAME##_rehash(table, table->size)) { \
+      return NULL;                                                             \
+    }                                                                          \
+    if (table->count >= table->grow_at &&                                      \
+        (table->size > INT_MAX / 2 ||                                          \
+         !ht_##NAME##_rehash(table, 2 * table->size))) {                       \
+      return NULL;                                                             \
+    }                                                                          \
+    ht_##NAME##_item_t item = {.key = key, .value = value};                    \
+    int index;                                                                 \
+    while ((index = ht_##NAME##_place(table->distances, table->items,          \
+                                      table->size, &item, hash)) < 0) {        \
+      if (table->size > INT_MAX / 2 ||                                         \
+          !ht_##NAME##_rehash(table, 2 * table->size)) {                       \
+        return NULL;                                                           \
+      }                                                                        \
+    }                                                                          \
+    table->count++;                                                            \
+    return &table->items[index];                                               \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_init(ht_##NAME##_t *table) {                                \
+    ht_##NAME##_init_size(table, HT_GENERIC_DEFAULT_SIZE);                     \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_init_size(ht_##NAME##_t *table, int size) {                 \
+    if (size <= 0) {                                                           \
+      size = HT_GENERIC_DEFAULT_SIZE;                                          \
+    }                                                                          \
+    table->min_size = ht_generic_round_size(size);                             \
+    table->seed = ht_random_seed();                                            \
+    table->distances = NULL;                                                   \
+    table->items = NULL;                                                       \
+    table->count = 0;                                                          \
+    ht_##NAME##_set_size(table, table->min_size);                              \
+  }                                                                            \
+                                                                               \
+  ht_##NAME##_item_t *ht_##NAME##_search(ht_##NAME##_t *table, K key) {        \
+    int index = ht_##NAME##_probe(table, key, HASH(key, table->seed));         \
+    return index >= 0 ? &table->items[index] : NULL;                           \
+  }                                                                            \
+                                                                               \
+  V *ht_##NAME##_get(ht_##NAME##_t *table, K key) {                            \
+    ht_##NAME##_item_t *item = ht_##NAME##_search(table, key);                 \
+    return item != NULL ? &item->value : NULL;                                 \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_insert(ht_##NAME##_t *table, K key, V value) {              \
+    uint64_t hash = HASH(key, table->seed);                                    \
+    int index = ht_##NAME##_probe(table, key, hash);                           \
+    if (index >= 0) {                                                          \
+      table->items[index].value = value;                                       \
+    } else {                                                                   \
+      ht_##NAME##_add(table, key, hash, value);                                \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  V *ht_##NAME##_upsert(ht_##NAME##_t *table, K key, bool *created) {          \
+    uint64_t hash = HASH(key, table->seed);                                    \
+    int index = ht_##NAME##_probe(table, key, hash);                           \
+    ht_##NAME##_item_t *item = index >= 0 ? &table->items[index] : NULL;       \
+    if (item == NULL) {                                                        \
+      ht_##NAME##_item_t zero;                                                 \
+      memset(&zero, 0, sizeof(zero));                                          \
+      item = ht_##NAME##_add(table, key, hash, zero.value);                    \
+    }                                                                          \
+    if (created != NULL) {                                                     \
+      *created = index < 0 && item != NULL;                                    \
+    }                                                                          \
+    return item != NULL ? &item->value : NULL;                                 \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_delete(ht_##NAME##_t *table, K key) {                       \
+    int index = ht_##NAME##_probe(table, key, HASH(key, table->seed));         \
+    if (index < 0) {                                                           \
+      return;                                                                  \
+    }                                                                          \
+    int mask = table->size - 1;                                                \
+    int next = (index + 1) & mask;                                             \
+    while (table->distances[next] > 1) {                                       \
+      table->items[index] = table->items[next];                                \
+      table->distances[index] = table->distances[next] - 1;                    \
+      index = next;                                                            \
+      next = (next + 1) & mask;                                                \
+    }                                                                          \
+    table->distances[index] = 0;                                               \
+    table->count--;                                                            \
+    if (table->count < table->shrink_at) {                                     \
+      int size = ht_generic_round_size(2 * table->count);                      \
+      ht_##NAME##_rehash(table,                                                \
+                         size > table->min_size ? size : table->min_size);     \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_delete_all(ht_##NAME##_t *table) {                          \
+    free(table->distances);                                                    \
+    free(table->items);                                                        \
+    table->distances = NULL;                                                   \
+    table->items = NULL;                                                       \
+    table->count = 0;                                                          \
+    ht_##NAME##_set_size(table, table->min_size);                              \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_foreach(ht_##NAME##_t *table, ht_##NAME##_visit_t visit,    \
+                           void *context) {                                    \
+    for (int i = 0; table->distances != NULL && i < table->size; i++) {        \
+      if (table->distances[i] != 0) {                                          \
+        visit(&table->items[i], context);                                      \
+      }                                                                        \
+    }                                                                          \
+  }
+
+HTDEC(uint64_t, double, u64, ht_hash_u64, ht_eq_u64)
+HTDEC(char *, double, str, ht_hash_str, ht_eq_str)
+
+#endif
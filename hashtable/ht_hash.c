@@ -0,0 +1,49 @@
+/*
+ * Rozptylovací funkce a náhodná semínka tabulek.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Rozptylovací funkce klíče key pro semínko seed, viz ht_hash.
+ */
+uint64_t get_hash(char *key, uint64_t seed) {
+  uint32_t key_length;
+  return ht_hash(key, seed, &key_length);
+}
+
+/*
+ * Náhodné semínko pro novou tabulku. Základ se při prvním volání načte
+ * z /dev/urandom (případně odvodí z času a adres) a každá další tabulka
+ * dostane jeho promíchání s čítačem. Přeložením s -DHT_FIXED_SEED=<číslo>
+ * mají všechny tabulky stejné semínko, což se hodí pro opakovatelné testy.
+ */
+uint64_t ht_random_seed(void) {
+#ifdef HT_FIXED_SEED
+  return HT_FIXED_SEED;
+#else
+  static _Atomic uint64_t base = 0;
+  static _Atomic uint64_t counter = 0;
+  uint64_t seed = atomic_load(&base);
+  if (seed == 0) {
+    FILE *random = fopen("/dev/urandom", "rb");
+    if (random != NULL) {
+      if (fread(&seed, sizeof(seed), 1, random) != 1) {
+        seed = 0;
+      }
+      fclose(random);
+    }
+    seed ^= ht_avalanche((uint64_t)time(NULL) ^ (uintptr_t)&seed);
+    seed |= 1;
+    uint64_t expected = 0;
+    if (!atomic_compare_exchange_strong(&base, &expected, seed)) {
+      seed = expected;
+    }
+  }
+  return ht_avalanche(seed + atomic_fetch_add(&counter, 1) * HT_PRIME_1);
+#endif
+}
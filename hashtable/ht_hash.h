@@ -0,0 +1,143 @@
+/*
+ * Rozptylovací funkce sdílená všemi implementacemi tabulky.
+ *
+ * Funkce ht_hash je definována přímo v hlavičce, aby ji překladač mohl vložit
+ * do vyhledávacích smyček jednotlivých implementací.
+ */
+
+#ifndef IAL_HASHTABLE_HT_HASH_H
+#define IAL_HASHTABLE_HT_HASH_H
+
+#include <stdint.h>
+
+/*
+ * Konstanty pro míchání bitů rozptylovací funkce (prvočísla z XXH64).
+ */
+#define HT_PRIME_1 0x9E3779B185EBCA87ULL
+#define HT_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define HT_PRIME_3 0x165667B19E3779F9ULL
+#define HT_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define HT_PRIME_5 0x27D4EB2F165667C5ULL
+
+/*
+ * Čtení klíče po celých 64bitových slovech je možné jen na little-endian
+ * architekturách s překladačem GCC nebo Clang; jinde se klíč čte po bytech.
+ */
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) &&                            \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HT_WORD_AT_A_TIME 1
+typedef uint64_t __attribute__((may_alias)) ht_word_t;
+#define HT_NO_SANITIZE __attribute__((no_sanitize_address))
+#else
+#define HT_WORD_AT_A_TIME 0
+#define HT_NO_SANITIZE
+#endif
+
+// Požadavek na načtení paměti na adrese p do vyrovnávací paměti předem
+#ifdef __GNUC__
+#define HT_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HT_PREFETCH(p) ((void)(p))
+#endif
+
+// Nejvyšší bit každého nulového bytu slova v (nad nulovým bytem může být
+// příznak i falešný, nejnižší nastavený bit je ale vždy přesný)
+#define HT_ZERO_BYTES(v)                                                       \
+  (((v) - 0x0101010101010101ULL) & ~(v) & 0x8080808080808080ULL)
+
+static inline uint64_t ht_rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+/*
+ * Zamíchá do stavu h dalších osm bytů klíče.
+ */
+static inline uint64_t ht_round(uint64_t h, uint64_t chunk) {
+  h ^= ht_rotl(chunk * HT_PRIME_2, 31) * HT_PRIME_1;
+  return ht_rotl(h, 27) * HT_PRIME_1 + HT_PRIME_4;
+}
+
+/*
+ * Závěrečné promíchání, po kterém každý bit vstupu ovlivní každý bit výsledku.
+ */
+static inline uint64_t ht_avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= HT_PRIME_2;
+  h ^= h >> 29;
+  h *= HT_PRIME_3;
+  h ^= h >> 32;
+  return h;
+}
+
+/*
+ * Rozptylovací funkce, která zadanému klíči přidělí 64bitovou hodnotu
+ * závislou na semínku seed. Každá tabulka má vlastní náhodné semínko, takže
+ * nelze dopředu sestavit klíče, které by všechny padly do jednoho řádku.
+ *
+ * Klíč se prochází jen jednou a po osmi bytech. Čte se vždy celé zarovnané
+ * slovo, takže čtení nikdy nepřekročí hranici stránky, a osmibytové úseky
+ * klíče se z dvojic zarovnaných slov skládají posunem, aby výsledek
+ * nezávisel na zarovnání klíče v paměti. Konec klíče se hledá v celém slově
+ * najednou. Čtení až sedmi bytů za koncem klíče v témže zarovnaném slově je
+ * záměrné, proto je funkce vyňata z kontrol AddressSanitizeru.
+ *
+ * Délku klíče, zjištěnou při témže průchodu, uloží do *key_length.
+ */
+static inline HT_NO_SANITIZE uint64_t ht_hash(char *key, uint64_t seed,
+                                              uint32_t *key_length) {
+  uint64_t h = seed + HT_PRIME_5;
+  uint64_t length = 0;
+  uint64_t chunk;
+#if HT_WORD_AT_A_TIME
+  int offset = (uintptr_t)key & 7;
+  int shift = 8 * offset;
+  const ht_word_t *word = (const ht_word_t *)(key - offset);
+  // byty slova před začátkem klíče, resp. už zpracované, se nezkoumají
+  uint64_t done = shift ? ~0ULL >> (64 - shift) : 0;
+  uint64_t current = *word++;
+  int bytes;
+  for (;;) {
+    uint64_t zero = HT_ZERO_BYTES(current | done);
+    if (zero != 0) {
+      bytes = __builtin_ctzll(zero) / 8 - offset;
+      chunk = current >> shift;
+      break;
+    }
+    uint64_t next = *word++;
+    chunk = (current >> shift) | ((next << (63 - shift)) << 1);
+    zero = HT_ZERO_BYTES(next) & done;
+    if (zero != 0) {
+      bytes = 8 - offset + __builtin_ctzll(zero) / 8;
+      break;
+    }
+    h = ht_round(h, chunk);
+    length += 8;
+    current = next;
+  }
+  chunk &= bytes ? ~0ULL >> (64 - 8 * bytes) : 0;
+  length += bytes;
+#else
+  const unsigned char *p = (const unsigned char *)key;
+  for (;;) {
+    int bytes = 0;
+    chunk = 0;
+    while (bytes < 8 && p[bytes] != '\0') {
+      chunk |= (uint64_t)p[bytes] << (8 * bytes);
+      bytes++;
+    }
+    length += bytes;
+    if (bytes < 8) {
+      break;
+    }
+    h = ht_round(h, chunk);
+    p += 8;
+  }
+#endif
+  h = ht_round(h, chunk);
+  *key_length = length;
+  return ht_avalanche(h ^ length * HT_PRIME_1);
+}
+
+uint64_t ht_random_seed(void);
+
+#endif
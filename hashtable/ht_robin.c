@@ -0,0 +1,521 @@
+/*
+ * Tabulka s rozptýlenými položkami — otevřené adresování podle Robin Hood
+ *
+ * Alternativní implementace funkcí ht_* ze souboru hashtable.h, která se
+ * použije při překladu s -DHT_BACKEND_ROBIN. Prvky leží přímo v poli
+ * políček a políčka se od domovského políčka klíče zkoušejí lineárně.
+ *
+ * Ke každému políčku patří byte se vzdáleností jeho prvku od domovského
+ * políčka. Vkládaný prvek předběhne každý prvek, který je svému domovu
+ * blíž než on sám, takže délky cest hledání zůstávají vyrovnané i při
+ * faktoru naplnění 0,9. Ze stejného důvodu hledání chybějícího klíče
+ * skončí na prvním prvku, který je svému domovu blíž, než by byl hledaný
+ * klíč, a nemusí dojít až k prázdnému políčku. Mazání nenechává značky
+ * smazaných políček: následující prvky téhož úseku se posunou o políčko
+ * zpět, blíž ke svému domovu.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nejmenší velikost pole
+#define HT_ROBIN_MIN_SIZE 8
+
+// Zvýší počítadlo counter tabulky o n; bez HT_STATS se nepřeloží nic
+#ifdef HT_STATS
+#define HT_COUNT(table, counter, n) ((table)->counters.counter += (n))
+#else
+#define HT_COUNT(table, counter, n) ((void)0)
+#endif
+
+/*
+ * Domovské políčko klíče s hodnotou rozptylovací funkce hash v poli, jehož
+ * velikost je mask + 1.
+ */
+static inline int ht_home(uint64_t hash, int mask) {
+  return (int)(hash >> 32) & mask;
+}
+
+/*
+ * Nejmenší mocnina dvou větší nebo rovná n, alespoň HT_ROBIN_MIN_SIZE.
+ */
+static int ht_round_size(int n) {
+  int size = HT_ROBIN_MIN_SIZE;
+  while (size < n && size <= INT_MAX / 2) {
+    size *= 2;
+  }
+  return size;
+}
+
+/*
+ * Nastaví velikost tabulky a přepočítá hranice pro změnu velikosti.
+ */
+static void ht_set_size(ht_table_t *table, int size) {
+  table->size = size;
+  table->grow_at = size * HT_MAX_LOAD_FACTOR;
+  table->shrink_at = size > table->min_size ? size * HT_MIN_LOAD_FACTOR : 0;
+}
+
+/*
+ * Index políčka s klíčem key, nebo -1, pokud klíč v tabulce není.
+ *
+ * Hledání končí na prázdném políčku nebo na prvku, který je svému domovu
+ * blíž, než by byl hledaný klíč: takový prvek by vkládaný klíč předběhl,
+ * klíč tedy nemůže ležet dál. Klíče se porovnávají jen u prvků se stejnou
+ * vzdáleností, tedy se stejným domovským políčkem.
+ */
+static int ht_probe(ht_table_t *table, char *key, uint64_t hash,
+                    uint32_t key_length) {
+  if (table->distances == NULL) {
+    return -1;
+  }
+  int mask = table->size - 1;
+  int index = ht_home(hash, mask);
+  for (int distance = 1;; distance++) {
+    HT_COUNT(table, probes, 1);
+    int stored = table->distances[index];
+    if (stored < distance) {
+      return -1;
+    }
+    ht_item_t *item = &table->items[index];
+    if (stored == distance && item->hash == hash &&
+        item->key_length == key_length &&
+        memcmp(item->key, key, key_length) == 0) {
+      return index;
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+/*
+ * Hledání klíče funkcí ht_probe započtené do počítadel tabulky.
+ */
+static int ht_find(ht_table_t *table, char *key, uint64_t hash,
+                   uint32_t key_length) {
+  int index = ht_probe(table, key, hash, key_length);
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, index >= 0);
+  HT_COUNT(table, misses, index < 0);
+  return index;
+}
+
+/*
+ * Uloží prvek item, jehož klíč v poli není, do polí distances a items
+ * velikosti size a vrátí index jeho políčka. Pole musí obsahovat prázdné
+ * políčko.
+ *
+ * Prvek se uloží na první políčko, jehož prvek je svému domovu blíž než
+ * vkládaný prvek, a zbytek úseku až k prázdnému políčku se posune o jedno
+ * políčko dál. Pokud by některý prvek překročil HT_MAX_DISTANCE, vrací -1
+ * a pole nemění.
+ */
+static int ht_place(uint8_t *distances, ht_item_t *items, int size,
+                    const ht_item_t *item) {
+  int mask = size - 1;
+  int index = ht_home(item->hash, mask);
+  int distance = 1;
+  while (distances[index] >= distance) {
+    index = (index + 1) & mask;
+    distance++;
+  }
+  if (distance > HT_MAX_DISTANCE + 1) {
+    return -1;
+  }
+  int end = index;
+  while (distances[end] != 0) {
+    if (distances[end] == HT_MAX_DISTANCE + 1) {
+      return -1;
+    }
+    end = (end + 1) & mask;
+  }
+  while (end != index) {
+    int previous = (end - 1) & mask;
+    items[end] = items[previous];
+    distances[end] = distances[previous] + 1;
+    end = previous;
+  }
+  items[index] = *item;
+  distances[index] = distance;
+  return index;
+}
+
+/*
+ * Přesune všechny prvky do nových polí velikosti size. Pokud by se v nich
+ * některý prvek vzdálil od domova víc než HT_MAX_DISTANCE, zkusí dvojnásobnou
+ * velikost. Pokud se nepodaří alokovat nová pole, vrací false a tabulka
+ * zůstává beze změny.
+ */
+static bool ht_rehash(ht_table_t *table, int size) {
+  for (;;) {
+    uint8_t *distances = calloc(size, sizeof(uint8_t));
+    ht_item_t *items = malloc(size * sizeof(ht_item_t));
+    if (distances == NULL || items == NULL) {
+      free(distances);
+      free(items);
+      return false;
+    }
+    bool placed = true;
+    for (int i = 0; table->distances != NULL && placed && i < table->size;
+         i++) {
+      if (table->distances[i] != 0) {
+        placed = ht_place(distances, items, size, &table->items[i]) >= 0;
+      }
+    }
+    if (placed) {
+      free(table->distances);
+      free(table->items);
+      table->distances = distances;
+      table->items = items;
+      ht_set_size(table, size);
+      return true;
+    }
+    free(distances);
+    free(items);
+    if (size > INT_MAX / 2) {
+      return false;
+    }
+    size *= 2;
+  }
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ *
+ * Počáteční velikost tabulky je HT_DEFAULT_SIZE zaokrouhlená nahoru na
+ * mocninu dvou. Pole se alokují až při prvním vložení prvku.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_size(table, HT_DEFAULT_SIZE);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí, zaokrouhlenou nahoru
+ * na mocninu dvou. Nekladná velikost znamená HT_DEFAULT_SIZE.
+ */
+void ht_init_size(ht_table_t *table, int size) {
+  if (table != NULL) {
+    table->min_size = ht_round_size(size > 0 ? size : HT_DEFAULT_SIZE);
+    table->seed = ht_random_seed();
+    table->distances = NULL;
+    table->items = NULL;
+    table->count = 0;
+    ht_set_size(table, table->min_size);
+#ifdef HT_STATS
+    table->counters = (ht_counters_t){0};
+#endif
+  }
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  return index >= 0 ? &table->items[index] : NULL;
+}
+
+/*
+ * Vyhledání více klíčů najednou.
+ *
+ * Do results[i] zapíše prvek s klíčem keys[i], nebo NULL. Klíče se
+ * zpracovávají po HT_BATCH_WINDOW: nejprve se pro všechny spočte hodnota
+ * rozptylovací funkce a vyžádá se načtení vzdáleností i políček od
+ * domovského políčka, teprve pak se klíče hledají.
+ */
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]) {
+  uint64_t hashes[HT_BATCH_WINDOW];
+  uint32_t key_lengths[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    char **window = keys + start;
+    if (table == NULL || table->distances == NULL) {
+      for (int i = 0; i < n; i++) {
+        results[start + i] = NULL;
+      }
+      continue;
+    }
+    int mask = table->size - 1;
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL) {
+        hashes[i] = ht_hash(window[i], table->seed, &key_lengths[i]);
+        int home = ht_home(hashes[i], mask);
+        HT_PREFETCH(table->distances + home);
+        HT_PREFETCH(table->items + home);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      int index = -1;
+      if (window[i] != NULL) {
+        index = ht_find(table, window[i], hashes[i], key_lengths[i]);
+      }
+      results[start + i] = index >= 0 ? &table->items[index] : NULL;
+    }
+  }
+}
+
+/*
+ * Získání hodnot více klíčů najednou.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Klíče vyhledá funkcí ht_search_batch.
+ */
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]) {
+  ht_item_t *items[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    ht_search_batch(table, keys + start, n, items);
+    for (int i = 0; i < n; i++) {
+      values[start + i] = items[i] != NULL ? &items[i]->value : NULL;
+    }
+  }
+}
+
+/*
+ * Uloží nový prvek s klíčem, o kterém volající ví, že v tabulce není.
+ * Pokud by počet prvků překročil HT_MAX_LOAD_FACTOR, nebo by prvek překročil
+ * HT_MAX_DISTANCE, tabulka se předtím zvětší. Vrací nový prvek, nebo NULL,
+ * pokud se nepodařilo alokovat paměť.
+ */
+static ht_item_t *ht_add(ht_table_t *table, char *key, uint64_t hash,
+                         uint32_t key_length, float value) {
+  if (table->distances == NULL && !ht_rehash(table, table->size)) {
+    return NULL;
+  }
+  if (table->count >= table->grow_at &&
+      (table->size > INT_MAX / 2 || !ht_rehash(table, 2 * table->size))) {
+    return NULL;
+  }
+
+  ht_item_t item = {
+      .key = key, .value = value, .key_length = key_length, .hash = hash};
+  int index;
+  while ((index = ht_place(table->distances, table->items, table->size,
+                           &item)) < 0) {
+    if (table->size > INT_MAX / 2 || !ht_rehash(table, 2 * table->size)) {
+      return NULL;
+    }
+  }
+  table->count++;
+  HT_COUNT(table, inserts, 1);
+  return &table->items[index];
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahradí jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  if (index >= 0) {
+    table->items[index].value = value;
+  } else {
+    ht_add(table, key, hash, key_length, value);
+  }
+}
+
+/*
+ * Vložení mnoha prvků najednou.
+ *
+ * Vloží count dvojic items[i].key, items[i].value; pro stejné klíče platí
+ * hodnota poslední dvojice. Tabulka se předem jednou zvětší tak, aby se
+ * všechny dvojice vešly bez další změny velikosti, viz ht_swiss.c.
+ */
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  int needed = (table->count + (double)count) / HT_MAX_LOAD_FACTOR + 1;
+  if (needed > table->size && needed <= INT_MAX / 2) {
+    ht_rehash(table, ht_round_size(needed));
+  }
+  for (int i = 0; i < count; i++) {
+    ht_insert(table, items[i].key, items[i].value);
+  }
+}
+
+/*
+ * Vyhledání prvku, případně jeho vložení s hodnotou 0, jedinou operací.
+ * Viz ht_upsert v hashtable.c.
+ */
+float *ht_upsert(ht_table_t *table, char *key, bool *created) {
+  if (created != NULL) {
+    *created = false;
+  }
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  if (index >= 0) {
+    return &table->items[index].value;
+  }
+  ht_item_t *item = ht_add(table, key, hash, key_length, 0);
+  if (item == NULL) {
+    return NULL;
+  }
+  if (created != NULL) {
+    *created = true;
+  }
+  return &item->value;
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *element = ht_search(table, key);
+  return element != NULL ? &element->value : NULL;
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Prvky za smazaným políčkem, které nejsou na svém domovském políčku, se
+ * až k prázdnému políčku nebo k prvku na domovském políčku posunou o jedno
+ * políčko zpět. Tabulka tak zůstane ve stavu, do kterého by se dostala bez
+ * vložení smazaného prvku, a značky smazaných políček nejsou potřeba.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  if (index < 0) {
+    return;
+  }
+  int mask = table->size - 1;
+  int next = (index + 1) & mask;
+  while (table->distances[next] > 1) {
+    table->items[index] = table->items[next];
+    table->distances[index] = table->distances[next] - 1;
+    index = next;
+    next = (next + 1) & mask;
+  }
+  table->distances[index] = 0;
+  table->count--;
+  HT_COUNT(table, deletes, 1);
+
+  if (table->count < table->shrink_at) {
+    int size = ht_round_size(2 * table->count);
+    ht_rehash(table, size > table->min_size ? size : table->min_size);
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Funkce uvolní obě pole a uvede tabulku do stavu po inicializaci.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  free(table->distances);
+  free(table->items);
+  table->distances = NULL;
+  table->items = NULL;
+  table->count = 0;
+  ht_set_size(table, table->min_size);
+}
+
+/*
+ * Vyprázdnění tabulky pro další použití.
+ *
+ * Pole počáteční velikosti ponechá a jen vynuluje vzdálenosti, čímž
+ * označí všechna políčka jako prázdná; tabulku jiné velikosti uvolní jako
+ * ht_delete_all.
+ */
+void ht_clear(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  if (table->distances == NULL || table->size != table->min_size) {
+    ht_delete_all(table);
+    return;
+  }
+  memset(table->distances, 0, table->size);
+  table->count = 0;
+}
+
+/*
+ * Faktor naplnění tabulky, tedy podíl obsazených políček.
+ */
+float ht_load_factor(ht_table_t *table) {
+  if (table == NULL || table->size == 0) {
+    return 0;
+  }
+  return (float)table->count / table->size;
+}
+
+/*
+ * Zavolá visit(item, context) pro každý prvek tabulky. Funkce visit nesmí
+ * tabulku měnit.
+ */
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context) {
+  if (table == NULL || table->distances == NULL) {
+    return;
+  }
+  for (int i = 0; i < table->size; i++) {
+    if (table->distances[i] != 0) {
+      visit(&table->items[i], context);
+    }
+  }
+}
+
+/*
+ * Zjistí stav tabulky do *stats. Histogram počítá prvky podle jejich
+ * vzdálenosti od domovského políčka; max_chain je počet políček, která
+ * prohlédne nejdelší hledání přítomného klíče.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(ht_stats_t));
+  if (table == NULL) {
+    return;
+  }
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->count = table->count;
+  stats->size = table->size;
+  stats->load_factor = ht_load_factor(table);
+  for (int i = 0; table->distances != NULL && i < table->size; i++) {
+    int stored = table->distances[i];
+    if (stored == 0) {
+      continue;
+    }
+    int distance = stored - 1;
+    stats->histogram[distance < HT_STATS_BINS ? distance
+                                              : HT_STATS_BINS - 1]++;
+    if (stored > stats->max_chain) {
+      stats->max_chain = stored;
+    }
+  }
+}
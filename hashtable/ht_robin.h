@@ -0,0 +1,55 @@
+/*
+ * Typy tabuľky s otvoreným adresovaním podľa Robin Hood (ht_robin.c).
+ * Súbor sa vkladá z hashtable.h pri preklade s -DHT_BACKEND_ROBIN.
+ *
+ * Políčka sa skúšajú lineárne od domovského políčka kľúča. Ku každému
+ * políčku patrí byte so vzdialenosťou uloženého prvku od jeho domovského
+ * políčka, podľa ktorej vkladanie vyrovnáva dĺžky ciest hľadania a hľadanie
+ * chýbajúceho kľúča končí skôr.
+ */
+
+#ifndef IAL_HASHTABLE_HT_ROBIN_H
+#define IAL_HASHTABLE_HT_ROBIN_H
+
+#define HT_ROBIN
+#define HT_BACKEND_NAME "robin"
+
+/*
+ * Hranice faktoru naplnenia. Vyrovnané cesty hľadania dovoľujú naplniť
+ * tabuľku viac ako pri swiss.
+ */
+#define HT_MAX_LOAD_FACTOR 0.9
+#define HT_MIN_LOAD_FACTOR 0.125
+
+/*
+ * Najväčšia vzdialenosť prvku od domovského políčka, ktorú možno uložiť do
+ * jedného bytu. Vloženie, ktoré by ju prekročilo, tabuľku najprv zväčší.
+ */
+#define HT_MAX_DISTANCE 254
+
+// Prvok tabuľky
+typedef struct ht_item {
+  char *key;           // kľúč prvku
+  float value;         // hodnota prvku
+  uint32_t key_length; // dĺžka kľúča bez ukončovacej nuly
+  uint64_t hash;       // neskrátená hodnota rozptyľovacej funkcie kľúča
+} ht_item_t;
+
+// Tabuľka s otvoreným adresovaním podľa Robin Hood
+typedef struct ht_table {
+  uint8_t *distances; // vzdialenosť prvku políčka od domovského políčka
+                      // zväčšená o 1, 0 pre prázdne políčko; NULL pred
+                      // prvým vložením
+  ht_item_t *items;   // políčka tabuľky
+  int size;           // počet políčok, mocnina dvoch
+  int count;          // počet prvkov v tabuľke
+  int min_size;       // počiatočná a zároveň najmenšia veľkosť tabuľky
+  int grow_at;        // počet prvkov, pri ktorom sa tabuľka zväčší
+  int shrink_at;      // počet prvkov, pri ktorom sa tabuľka zmenší
+  uint64_t seed;      // semienko rozptyľovacej funkcie tejto tabuľky
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá volaní
+#endif
+} ht_table_t;
+
+#endif
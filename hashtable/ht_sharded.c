@@ -0,0 +1,298 @@
+/*
+ * Tabulka rozdělená na nezávislé části
+ *
+ * Každá část je tabulka zvolené implementace se svým zámkem. Klíč se
+ * zpracuje rozptylovací funkcí se semínkem rozdělené tabulky a horních
+ * 32 bitů výsledku určí část stejně jako ht_index v hashtable.c určí
+ * řádek. Tabulka části pak klíč zpracuje znovu se svým semínkem; semínko
+ * pro výběr části se od semínek částí liší, aby klíče jedné části
+ * nepadaly jen do úseku jejích řádků.
+ *
+ * Dávkové funkce spočtou části všech klíčů dávky, stabilně seřadí operace
+ * podle částí (řazením počítáním) a pak každou část zamknou jednou pro
+ * všechny její operace. Pořadí operací uvnitř části zůstává, výsledek je
+ * proto stejný jako při postupném volání jednotlivých funkcí. Pokud se
+ * nepodaří alokovat pomocnou paměť, provedou se operace jednotlivě.
+ */
+
+#include "ht_sharded.h"
+#include "ht_hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Část rozdělené tabulky, do které patří klíč key
+static inline int ht_shard_index(const ht_sharded_t *sharded, char *key) {
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, sharded->seed, &key_length);
+  return (int)(((hash >> 32) * (uint64_t)sharded->count) >> 32);
+}
+
+static inline ht_shard_t *ht_shard(ht_sharded_t *sharded, char *key) {
+  return &sharded->shards[ht_shard_index(sharded, key)];
+}
+
+/*
+ * Inicializace rozdělené tabulky s count částmi pro celkem asi size prvků.
+ *
+ * Nekladný počet částí znamená HT_SHARDS_DEFAULT, nekladná velikost
+ * výchozí velikost tabulek částí. Vrací false, pokud se nepodařilo
+ * alokovat paměť; struktura je pak prázdná.
+ */
+bool ht_sharded_init(ht_sharded_t *sharded, int count, int size) {
+  if (sharded == NULL) {
+    return false;
+  }
+  sharded->count = count > 0 ? count : HT_SHARDS_DEFAULT;
+  sharded->seed = ht_random_seed() ^ HT_PRIME_3;
+  sharded->shards =
+      aligned_alloc(HT_SHARD_ALIGN, sharded->count * sizeof(ht_shard_t));
+  if (sharded->shards == NULL) {
+    sharded->count = 0;
+    return false;
+  }
+  for (int i = 0; i < sharded->count; i++) {
+    pthread_mutex_init(&sharded->shards[i].lock, NULL);
+    ht_init_size(&sharded->shards[i].table,
+                 size > 0 ? size / sharded->count + 1 : 0);
+  }
+  return true;
+}
+
+/*
+ * Uvolnění rozdělené tabulky i všech jejích částí. Žádné jiné vlákno ji
+ * v tu chvíli nesmí používat.
+ */
+void ht_sharded_free(ht_sharded_t *sharded) {
+  if (sharded == NULL || sharded->shards == NULL) {
+    return;
+  }
+  for (int i = 0; i < sharded->count; i++) {
+    ht_delete_all(&sharded->shards[i].table);
+    pthread_mutex_destroy(&sharded->shards[i].lock);
+  }
+  free(sharded->shards);
+  sharded->shards = NULL;
+  sharded->count = 0;
+}
+
+/*
+ * Vložení prvku, případně přepsání hodnoty existujícího klíče, pod zámkem
+ * jeho části.
+ */
+void ht_sharded_insert(ht_sharded_t *sharded, char *key, float value) {
+  if (sharded == NULL || sharded->shards == NULL || key == NULL) {
+    return;
+  }
+  ht_shard_t *shard = ht_shard(sharded, key);
+  pthread_mutex_lock(&shard->lock);
+  ht_insert(&shard->table, key, value);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+/*
+ * Přečtení hodnoty klíče. Hodnotu zkopíruje do *value pod zámkem části,
+ * protože ukazatel do tabulky by jiné vlákno mohlo vzápětí zneplatnit.
+ * Vrací false, pokud klíč v tabulce není.
+ */
+bool ht_sharded_read(ht_sharded_t *sharded, char *key, float *value) {
+  if (sharded == NULL || sharded->shards == NULL || key == NULL) {
+    return false;
+  }
+  ht_shard_t *shard = ht_shard(sharded, key);
+  pthread_mutex_lock(&shard->lock);
+  float *found = ht_get(&shard->table, key);
+  if (found != NULL) {
+    *value = *found;
+  }
+  pthread_mutex_unlock(&shard->lock);
+  return found != NULL;
+}
+
+// Smazání prvku pod zámkem jeho části; chybějící klíč nevadí
+void ht_sharded_delete(ht_sharded_t *sharded, char *key) {
+  if (sharded == NULL || sharded->shards == NULL || key == NULL) {
+    return;
+  }
+  ht_shard_t *shard = ht_shard(sharded, key);
+  pthread_mutex_lock(&shard->lock);
+  ht_delete(&shard->table, key);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+/*
+ * Pomocná paměť dávky: operace seřazené podle částí. Indexy operací části
+ * s leží v order[starts[s]] až order[starts[s + 1] - 1]. Všechna pole leží
+ * v jediné alokaci začínající polem keys.
+ */
+typedef struct ht_batch {
+  char **keys;       // klíče operací ve stejném pořadí jako order
+  ht_item_t **found; // výsledky hledání ve stejném pořadí jako order
+  int *order;        // indexy operací seřazené podle částí
+  int *starts;       // začátky částí v order, count částí + 1 položek
+} ht_batch_t;
+
+/*
+ * Seřadí count operací s klíči keys[i] (nebo items[i].key, je-li keys
+ * NULL) podle částí. Klíče NULL se vynechají. Vrací false, pokud se
+ * nepodařilo alokovat paměť; pak batch nic nedrží.
+ */
+static bool ht_batch_group(ht_sharded_t *sharded, char *keys[],
+                           const ht_item_t items[], int count,
+                           ht_batch_t *batch) {
+  size_t bytes = (size_t)count * (sizeof(char *) + sizeof(ht_item_t *) +
+                                  2 * sizeof(int)) +
+                 (sharded->count + 1) * sizeof(int);
+  batch->keys = malloc(bytes);
+  if (batch->keys == NULL) {
+    return false;
+  }
+  batch->found = (ht_item_t **)(batch->keys + count);
+  batch->order = (int *)(batch->found + count);
+  int *shard_of = batch->order + count;
+  batch->starts = shard_of + count;
+  memset(batch->starts, 0, (sharded->count + 1) * sizeof(int));
+  for (int i = 0; i < count; i++) {
+    char *key = keys != NULL ? keys[i] : items[i].key;
+    shard_of[i] = key != NULL ? ht_shard_index(sharded, key) : -1;
+    if (key != NULL) {
+      batch->starts[shard_of[i] + 1]++;
+    }
+  }
+  for (int s = 0; s < sharded->count; s++) {
+    batch->starts[s + 1] += batch->starts[s];
+  }
+  // starts[s] slouží během řazení jako další volná pozice části s
+  for (int i = 0; i < count; i++) {
+    if (shard_of[i] >= 0) {
+      int position = batch->starts[shard_of[i]]++;
+      batch->order[position] = i;
+      batch->keys[position] = keys != NULL ? keys[i] : items[i].key;
+    }
+  }
+  for (int s = sharded->count; s > 0; s--) {
+    batch->starts[s] = batch->starts[s - 1];
+  }
+  batch->starts[0] = 0;
+  return true;
+}
+
+static void ht_batch_free(ht_batch_t *batch) { free(batch->keys); }
+
+/*
+ * Vložení count dvojic items[i].key, items[i].value. Každá část se zamkne
+ * jednou pro všechny své dvojice; pro stejné klíče platí hodnota poslední
+ * dvojice jako u postupného vkládání.
+ */
+void ht_sharded_insert_batch(ht_sharded_t *sharded, const ht_item_t items[],
+                             int count) {
+  if (sharded == NULL || sharded->shards == NULL || items == NULL ||
+      count <= 0) {
+    return;
+  }
+  ht_batch_t batch;
+  if (!ht_batch_group(sharded, NULL, items, count, &batch)) {
+    for (int i = 0; i < count; i++) {
+      ht_sharded_insert(sharded, items[i].key, items[i].value);
+    }
+    return;
+  }
+  for (int s = 0; s < sharded->count; s++) {
+    if (batch.starts[s] == batch.starts[s + 1]) {
+      continue;
+    }
+    ht_shard_t *shard = &sharded->shards[s];
+    pthread_mutex_lock(&shard->lock);
+    for (int j = batch.starts[s]; j < batch.starts[s + 1]; j++) {
+      ht_insert(&shard->table, batch.keys[j], items[batch.order[j]].value);
+    }
+    pthread_mutex_unlock(&shard->lock);
+  }
+  ht_batch_free(&batch);
+}
+
+/*
+ * Přečtení hodnot count klíčů. Do found[i] zapíše, zda klíč keys[i]
+ * v tabulce je, a pokud ano, do values[i] jeho hodnotu. Klíče jedné části
+ * se pod jejím zámkem vyhledají funkcí ht_search_batch.
+ */
+void ht_sharded_read_batch(ht_sharded_t *sharded, char *keys[], int count,
+                           float values[], bool found[]) {
+  if (keys == NULL || count <= 0) {
+    return;
+  }
+  for (int i = 0; i < count; i++) {
+    found[i] = false;
+  }
+  if (sharded == NULL || sharded->shards == NULL) {
+    return;
+  }
+  ht_batch_t batch;
+  if (!ht_batch_group(sharded, keys, NULL, count, &batch)) {
+    for (int i = 0; i < count; i++) {
+      found[i] = ht_sharded_read(sharded, keys[i], &values[i]);
+    }
+    return;
+  }
+  for (int s = 0; s < sharded->count; s++) {
+    int start = batch.starts[s];
+    int n = batch.starts[s + 1] - start;
+    if (n == 0) {
+      continue;
+    }
+    ht_shard_t *shard = &sharded->shards[s];
+    pthread_mutex_lock(&shard->lock);
+    ht_search_batch(&shard->table, batch.keys + start, n, batch.found + start);
+    for (int j = start; j < start + n; j++) {
+      if (batch.found[j] != NULL) {
+        values[batch.order[j]] = batch.found[j]->value;
+        found[batch.order[j]] = true;
+      }
+    }
+    pthread_mutex_unlock(&shard->lock);
+  }
+  ht_batch_free(&batch);
+}
+
+// Smazání count klíčů; každá část se zamkne jednou pro všechny své klíče
+void ht_sharded_delete_batch(ht_sharded_t *sharded, char *keys[], int count) {
+  if (sharded == NULL || sharded->shards == NULL || keys == NULL ||
+      count <= 0) {
+    return;
+  }
+  ht_batch_t batch;
+  if (!ht_batch_group(sharded, keys, NULL, count, &batch)) {
+    for (int i = 0; i < count; i++) {
+      ht_sharded_delete(sharded, keys[i]);
+    }
+    return;
+  }
+  for (int s = 0; s < sharded->count; s++) {
+    if (batch.starts[s] == batch.starts[s + 1]) {
+      continue;
+    }
+    ht_shard_t *shard = &sharded->shards[s];
+    pthread_mutex_lock(&shard->lock);
+    for (int j = batch.starts[s]; j < batch.starts[s + 1]; j++) {
+      ht_delete(&shard->table, batch.keys[j]);
+    }
+    pthread_mutex_unlock(&shard->lock);
+  }
+  ht_batch_free(&batch);
+}
+
+/*
+ * Počet prvků všech částí. Počty se zjistí funkcí ht_stats postupně pod
+ * zámkem každé části, při souběžném zápisu jde tedy jen o odhad; volání
+ * prochází celé tabulky částí a slouží pro ladění a měření.
+ */
+int ht_sharded_count(ht_sharded_t *sharded) {
+  int count = 0;
+  for (int i = 0; sharded != NULL && i < sharded->count; i++) {
+    ht_stats_t stats;
+    pthread_mutex_lock(&sharded->shards[i].lock);
+    ht_stats(&sharded->shards[i].table, &stats);
+    pthread_mutex_unlock(&sharded->shards[i].lock);
+    count += stats.count;
+  }
+  return count;
+}
@@ -0,0 +1,55 @@
+/*
+ * Tabuľka rozdelená na nezávislé časti pre súbežný zápis (ht_sharded.c).
+ *
+ * Kľúč sa podľa horných bitov vlastnej rozptyľovacej funkcie smeruje do
+ * jednej z count častí. Každá časť je samostatná tabuľka zvolenej
+ * implementácie so svojím zámkom a so svojou pamäťou prvkov (pri
+ * zreťazenej implementácii zásobník), zarovnaná na riadok vyrovnávacej
+ * pamäte, takže vlákna pracujúce s rôznymi časťami nezdieľajú žiadny
+ * zapisovaný riadok. Pri počte častí aspoň rovnom počtu jadier sa zápisy
+ * rôznych vlákien zriedka stretnú na jednom zámku.
+ *
+ * Dávkové funkcie ht_sharded_*_batch zoskupia operácie dávky podľa častí
+ * a každú časť zamknú len raz za dávku.
+ */
+
+#ifndef IAL_HASHTABLE_HT_SHARDED_H
+#define IAL_HASHTABLE_HT_SHARDED_H
+
+#include "hashtable.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Počet častí, ktorý použije ht_sharded_init pre nekladný počet
+#define HT_SHARDS_DEFAULT 64
+
+// Veľkosť riadku vyrovnávacej pamäte, na ktorú sú zarovnané časti
+#define HT_SHARD_ALIGN 64
+
+// Časť tabuľky so zámkom, každá začína v samostatnom riadku pamäte
+typedef struct ht_shard {
+  _Alignas(HT_SHARD_ALIGN) pthread_mutex_t lock; // zámok časti
+  ht_table_t table;                              // tabuľka časti
+} ht_shard_t;
+
+// Tabuľka rozdelená na časti
+typedef struct ht_sharded {
+  ht_shard_t *shards; // časti, NULL pre prázdnu štruktúru
+  int count;          // počet častí
+  uint64_t seed;      // semienko rozptyľovacej funkcie pre výber časti
+} ht_sharded_t;
+
+bool ht_sharded_init(ht_sharded_t *sharded, int count, int size);
+void ht_sharded_free(ht_sharded_t *sharded);
+void ht_sharded_insert(ht_sharded_t *sharded, char *key, float value);
+bool ht_sharded_read(ht_sharded_t *sharded, char *key, float *value);
+void ht_sharded_delete(ht_sharded_t *sharded, char *key);
+void ht_sharded_insert_batch(ht_sharded_t *sharded, const ht_item_t items[],
+                             int count);
+void ht_sharded_read_batch(ht_sharded_t *sharded, char *keys[], int count,
+                           float values[], bool found[]);
+void ht_sharded_delete_batch(ht_sharded_t *sharded, char *keys[], int count);
+int ht_sharded_count(ht_sharded_t *sharded);
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Výpis stavu tabulky společný všem implementacím
+ *
+ * Stav zjištěný funkcí ht_stats se vypíše na jeden řádek jako dvojice
+ * klíč=hodnota oddělené mezerami, aby jej šlo zpracovat strojově. Počítadla
+ * volání se vypisují jen při překladu s -DHT_STATS, histogram jako hodnoty
+ * histogram[0] až histogram[HT_STATS_BINS - 1] oddělené čárkami.
+ */
+
+#include "hashtable.h"
+#include <inttypes.h>
+
+/*
+ * Vypíše stav tabulky do out jedním řádkem, například:
+ *
+ *   backend=chained count=15 size=101 load=0.149 max_chain=2 histogram=...
+ */
+void ht_stats_print(ht_table_t *table, FILE *out) {
+  ht_stats_t stats;
+  ht_stats(table, &stats);
+  fprintf(out, "backend=%s count=%i size=%i load=%.3f max_chain=%i",
+          HT_BACKEND_NAME, stats.count, stats.size, stats.load_factor,
+          stats.max_chain);
+#ifdef HT_STATS
+  fprintf(out,
+          " lookups=%" PRIu64 " hits=%" PRIu64 " misses=%" PRIu64
+          " probes=%" PRIu64 " inserts=%" PRIu64 " deletes=%" PRIu64,
+          stats.counters.lookups, stats.counters.hits, stats.counters.misses,
+          stats.counters.probes, stats.counters.inserts,
+          stats.counters.deletes);
+#endif
+  for (int i = 0; i < HT_STATS_BINS; i++) {
+    fprintf(out, "%s%i", i == 0 ? " histogram=" : ",", stats.histogram[i]);
+  }
+  fprintf(out, "\n");
+}
@@ -0,0 +1,560 @@
+/*
+ * Tabulka s rozptýlenými položkami — otevřené adresování s řídicími byty
+ *
+ * Alternativní implementace funkcí ht_* ze souboru hashtable.h, která se
+ * použije při překladu s -DHT_BACKEND_SWISS. Prvky leží přímo v poli
+ * políček, takže vložení nealokuje paměť a hledání nesleduje ukazatele.
+ *
+ * Ke každému políčku patří řídicí byte. Obsazené políčko má v něm sedm bitů
+ * hodnoty rozptylovací funkce klíče (h2), volné políčko zápornou značku
+ * prázdného nebo smazaného políčka. Políčka tvoří skupiny po HT_GROUP_WIDTH;
+ * zbylé bity hodnoty rozptylovací funkce určí první prohledávanou skupinu.
+ * Řídicí byty celé skupiny se s h2 porovnají jedinou instrukcí SSE2 a klíče
+ * se porovnávají jen u políček, jejichž byte se shoduje. Hledání končí ve
+ * skupině, která obsahuje prázdné políčko.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Řídicí byty volných políček; obsazené políčko má hodnotu h2 z <0,127>
+#define HT_CTRL_EMPTY ((int8_t)-128)
+#define HT_CTRL_DELETED ((int8_t)-2)
+
+static inline int8_t ht_h2(uint64_t hash) { return hash & 0x7F; }
+
+// Zvýší počítadlo counter tabulky o n; bez HT_STATS se nepřeloží nic
+#ifdef HT_STATS
+#define HT_COUNT(table, counter, n) ((table)->counters.counter += (n))
+#else
+#define HT_COUNT(table, counter, n) ((void)0)
+#endif
+
+/*
+ * Index první prohledávané skupiny; bere horní bity, nezávislé na h2.
+ */
+static inline int ht_first_group(uint64_t hash, int group_mask) {
+  return (int)(hash >> 32) & group_mask;
+}
+
+static inline int ht_ctz(uint32_t mask) {
+#ifdef __GNUC__
+  return __builtin_ctz(mask);
+#else
+  int i = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+/*
+ * Bitová maska políček skupiny group, jejichž řídicí byte je roven value.
+ */
+static inline uint32_t ht_group_match(const int8_t *group, int8_t value) {
+#ifdef __SSE2__
+  __m128i ctrl = _mm_load_si128((const __m128i *)group);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < HT_GROUP_WIDTH; i++) {
+    mask |= (uint32_t)(group[i] == value) << i;
+  }
+  return mask;
+#endif
+}
+
+/*
+ * Bitová maska volných (prázdných nebo smazaných) políček skupiny group.
+ * Obě značky jsou záporné, stačí tedy nejvyšší bit každého bytu.
+ */
+static inline uint32_t ht_group_match_free(const int8_t *group) {
+#ifdef __SSE2__
+  return _mm_movemask_epi8(_mm_load_si128((const __m128i *)group));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < HT_GROUP_WIDTH; i++) {
+    mask |= (uint32_t)(group[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+/*
+ * Nejmenší mocnina dvou větší nebo rovná n, alespoň HT_GROUP_WIDTH.
+ */
+static int ht_round_size(int n) {
+  int size = HT_GROUP_WIDTH;
+  while (size < n && size <= INT_MAX / 2) {
+    size *= 2;
+  }
+  return size;
+}
+
+/*
+ * Nastaví velikost tabulky a přepočítá hranice pro změnu velikosti.
+ */
+static void ht_set_size(ht_table_t *table, int size) {
+  table->size = size;
+  table->grow_at = size * HT_MAX_LOAD_FACTOR;
+  table->shrink_at = size > table->min_size ? size * HT_MIN_LOAD_FACTOR : 0;
+}
+
+/*
+ * Index políčka s klíčem key, nebo -1, pokud klíč v tabulce není.
+ * Skupiny se procházejí trojúhelníkovou posloupností, která při počtu
+ * skupin rovném mocnině dvou navštíví každou skupinu právě jednou.
+ */
+static int ht_probe(ht_table_t *table, char *key, uint64_t hash,
+                    uint32_t key_length) {
+  if (table->ctrl == NULL) {
+    return -1;
+  }
+  int8_t h2 = ht_h2(hash);
+  int group_mask = table->size / HT_GROUP_WIDTH - 1;
+  int group = ht_first_group(hash, group_mask);
+  for (int step = 1; step <= group_mask + 1; step++) {
+    const int8_t *ctrl = table->ctrl + group * HT_GROUP_WIDTH;
+    HT_COUNT(table, probes, 1);
+    for (uint32_t match = ht_group_match(ctrl, h2); match != 0;
+         match &= match - 1) {
+      int index = group * HT_GROUP_WIDTH + ht_ctz(match);
+      ht_item_t *item = &table->items[index];
+      if (item->hash == hash && item->key_length == key_length &&
+          memcmp(item->key, key, key_length) == 0) {
+        return index;
+      }
+    }
+    if (ht_group_match(ctrl, HT_CTRL_EMPTY) != 0) {
+      return -1;
+    }
+    group = (group + step) & group_mask;
+  }
+  return -1;
+}
+
+/*
+ * Hledání klíče funkcí ht_probe započtené do počítadel tabulky.
+ */
+static int ht_find(ht_table_t *table, char *key, uint64_t hash,
+                   uint32_t key_length) {
+  int index = ht_probe(table, key, hash, key_length);
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, index >= 0);
+  HT_COUNT(table, misses, index < 0);
+  return index;
+}
+
+/*
+ * Index prvního volného políčka na cestě hledání klíče s hodnotou hash.
+ * Tabulka vždy obsahuje volné políčko, protože se zvětšuje dřív, než se
+ * zaplní.
+ */
+static int ht_find_free(ht_table_t *table, uint64_t hash) {
+  int group_mask = table->size / HT_GROUP_WIDTH - 1;
+  int group = ht_first_group(hash, group_mask);
+  for (int step = 1;; step++) {
+    uint32_t match = ht_group_match_free(table->ctrl + group * HT_GROUP_WIDTH);
+    if (match != 0) {
+      return group * HT_GROUP_WIDTH + ht_ctz(match);
+    }
+    group = (group + step) & group_mask;
+  }
+}
+
+/*
+ * Přesune všechny prvky do nových polí velikosti size a zahodí značky
+ * smazaných políček. Uložená hodnota rozptylovací funkce se znovu
+ * nepočítá. Pokud se nepodaří alokovat nová pole, vrací false a tabulka
+ * zůstává beze změny.
+ */
+static bool ht_rehash(ht_table_t *table, int size) {
+  int8_t *ctrl = aligned_alloc(HT_GROUP_WIDTH, size);
+  ht_item_t *items = malloc(size * sizeof(ht_item_t));
+  if (ctrl == NULL || items == NULL) {
+    free(ctrl);
+    free(items);
+    return false;
+  }
+  memset(ctrl, HT_CTRL_EMPTY, size);
+
+  int8_t *old_ctrl = table->ctrl;
+  ht_item_t *old_items = table->items;
+  int old_size = table->size;
+  table->ctrl = ctrl;
+  table->items = items;
+  table->deleted = 0;
+  ht_set_size(table, size);
+  if (old_ctrl != NULL) {
+    for (int i = 0; i < old_size; i++) {
+      if (old_ctrl[i] >= 0) {
+        int index = ht_find_free(table, old_items[i].hash);
+        ctrl[index] = old_ctrl[i];
+        items[index] = old_items[i];
+      }
+    }
+  }
+  free(old_ctrl);
+  free(old_items);
+  return true;
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ *
+ * Počáteční velikost tabulky je HT_DEFAULT_SIZE zaokrouhlená nahoru na
+ * mocninu dvou. Pole se alokují až při prvním vložení prvku.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_size(table, HT_DEFAULT_SIZE);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí, zaokrouhlenou nahoru
+ * na mocninu dvou. Nekladná velikost znamená HT_DEFAULT_SIZE.
+ */
+void ht_init_size(ht_table_t *table, int size) {
+  if (table != NULL) {
+    table->min_size = ht_round_size(size > 0 ? size : HT_DEFAULT_SIZE);
+    table->seed = ht_random_seed();
+    table->ctrl = NULL;
+    table->items = NULL;
+    table->count = 0;
+    table->deleted = 0;
+    ht_set_size(table, table->min_size);
+#ifdef HT_STATS
+    table->counters = (ht_counters_t){0};
+#endif
+  }
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  return index >= 0 ? &table->items[index] : NULL;
+}
+
+/*
+ * Vyhledání více klíčů najednou.
+ *
+ * Do results[i] zapíše prvek s klíčem keys[i], nebo NULL. Klíče se
+ * zpracovávají po HT_BATCH_WINDOW: nejprve se pro všechny spočte hodnota
+ * rozptylovací funkce a vyžádá se načtení první skupiny řídicích bytů
+ * i odpovídajících políček, teprve pak se klíče hledají.
+ */
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]) {
+  uint64_t hashes[HT_BATCH_WINDOW];
+  uint32_t key_lengths[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    char **window = keys + start;
+    if (table == NULL || table->ctrl == NULL) {
+      for (int i = 0; i < n; i++) {
+        results[start + i] = NULL;
+      }
+      continue;
+    }
+    int group_mask = table->size / HT_GROUP_WIDTH - 1;
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL) {
+        hashes[i] = ht_hash(window[i], table->seed, &key_lengths[i]);
+        int first = ht_first_group(hashes[i], group_mask) * HT_GROUP_WIDTH;
+        HT_PREFETCH(table->ctrl + first);
+        HT_PREFETCH(table->items + first);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      int index = -1;
+      if (window[i] != NULL) {
+        index = ht_find(table, window[i], hashes[i], key_lengths[i]);
+      }
+      results[start + i] = index >= 0 ? &table->items[index] : NULL;
+    }
+  }
+}
+
+/*
+ * Získání hodnot více klíčů najednou.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Klíče vyhledá funkcí ht_search_batch.
+ */
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]) {
+  ht_item_t *items[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    ht_search_batch(table, keys + start, n, items);
+    for (int i = 0; i < n; i++) {
+      values[start + i] = items[i] != NULL ? &items[i]->value : NULL;
+    }
+  }
+}
+
+/*
+ * Uloží nový prvek s klíčem, o kterém volající ví, že v tabulce není, do
+ * prvního volného políčka na cestě hledání. Pokud by obsazená a smazaná
+ * políčka překročila HT_MAX_LOAD_FACTOR, tabulka se předtím zvětší, nebo
+ * při velkém počtu smazaných políček jen pročistí. Vrací nový prvek, nebo
+ * NULL, pokud se nepodařilo alokovat paměť.
+ */
+static ht_item_t *ht_add(ht_table_t *table, char *key, uint64_t hash,
+                         uint32_t key_length, float value) {
+  if (table->ctrl == NULL && !ht_rehash(table, table->size)) {
+    return NULL;
+  }
+  if (table->count + table->deleted >= table->grow_at) {
+    bool grow = table->count >= table->grow_at / 2;
+    if (grow && table->size > INT_MAX / 2) {
+      return NULL;
+    }
+    if (!ht_rehash(table, grow ? 2 * table->size : table->size)) {
+      return NULL;
+    }
+  }
+
+  int index = ht_find_free(table, hash);
+  if (table->ctrl[index] == HT_CTRL_DELETED) {
+    table->deleted--;
+  }
+  table->ctrl[index] = ht_h2(hash);
+  ht_item_t *item = &table->items[index];
+  item->key = key;
+  item->value = value;
+  item->key_length = key_length;
+  item->hash = hash;
+  table->count++;
+  HT_COUNT(table, inserts, 1);
+  return item;
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahradí jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  if (index >= 0) {
+    table->items[index].value = value;
+  } else {
+    ht_add(table, key, hash, key_length, value);
+  }
+}
+
+/*
+ * Vložení mnoha prvků najednou.
+ *
+ * Vloží count dvojic items[i].key, items[i].value; pro stejné klíče platí
+ * hodnota poslední dvojice. Tabulka se předem jednou zvětší tak, aby se
+ * všechny dvojice vešly bez další změny velikosti. Prvky leží přímo
+ * v poli políček, souvislé rozložení seznamů tu tedy nemá smysl.
+ */
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  int needed = (table->count + (double)count) / HT_MAX_LOAD_FACTOR + 1;
+  if (needed > table->size && needed <= INT_MAX / 2) {
+    ht_rehash(table, ht_round_size(needed));
+  }
+  for (int i = 0; i < count; i++) {
+    ht_insert(table, items[i].key, items[i].value);
+  }
+}
+
+/*
+ * Vyhledání prvku, případně jeho vložení s hodnotou 0, jedinou operací.
+ * Viz ht_upsert v hashtable.c.
+ */
+float *ht_upsert(ht_table_t *table, char *key, bool *created) {
+  if (created != NULL) {
+    *created = false;
+  }
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  if (index >= 0) {
+    return &table->items[index].value;
+  }
+  ht_item_t *item = ht_add(table, key, hash, key_length, 0);
+  if (item == NULL) {
+    return NULL;
+  }
+  if (created != NULL) {
+    *created = true;
+  }
+  return &item->value;
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *element = ht_search(table, key);
+  return element != NULL ? &element->value : NULL;
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Pokud skupina smazaného políčka obsahuje prázdné políčko, nikdy nebyla
+ * plná, žádné hledání ji tedy nemohlo přeskočit a políčko smí být prázdné.
+ * Jinak se označí jako smazané, aby hledání pokračovalo dál.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int index = ht_find(table, key, hash, key_length);
+  if (index < 0) {
+    return;
+  }
+  int8_t *group = table->ctrl + index / HT_GROUP_WIDTH * HT_GROUP_WIDTH;
+  if (ht_group_match(group, HT_CTRL_EMPTY) != 0) {
+    table->ctrl[index] = HT_CTRL_EMPTY;
+  } else {
+    table->ctrl[index] = HT_CTRL_DELETED;
+    table->deleted++;
+  }
+  table->count--;
+  HT_COUNT(table, deletes, 1);
+
+  if (table->count < table->shrink_at) {
+    int size = ht_round_size(2 * table->count);
+    ht_rehash(table, size > table->min_size ? size : table->min_size);
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Funkce uvolní obě pole a uvede tabulku do stavu po inicializaci.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  free(table->ctrl);
+  free(table->items);
+  table->ctrl = NULL;
+  table->items = NULL;
+  table->count = 0;
+  table->deleted = 0;
+  ht_set_size(table, table->min_size);
+}
+
+/*
+ * Vyprázdnění tabulky pro další použití.
+ *
+ * Pole počáteční velikosti ponechá a jen označí všechna políčka jako
+ * prázdná; tabulku jiné velikosti uvolní jako ht_delete_all.
+ */
+void ht_clear(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  if (table->ctrl == NULL || table->size != table->min_size) {
+    ht_delete_all(table);
+    return;
+  }
+  memset(table->ctrl, HT_CTRL_EMPTY, table->size);
+  table->count = 0;
+  table->deleted = 0;
+}
+
+/*
+ * Faktor naplnění tabulky, tedy podíl obsazených políček.
+ */
+float ht_load_factor(ht_table_t *table) {
+  if (table == NULL || table->size == 0) {
+    return 0;
+  }
+  return (float)table->count / table->size;
+}
+
+/*
+ * Zavolá visit(item, context) pro každý prvek tabulky. Obsazená políčka se
+ * hledají po celých skupinách řídicích bytů. Funkce visit nesmí tabulku
+ * měnit.
+ */
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context) {
+  if (table == NULL || table->ctrl == NULL) {
+    return;
+  }
+  for (int group = 0; group < table->size; group += HT_GROUP_WIDTH) {
+    uint32_t full = ~ht_group_match_free(table->ctrl + group) &
+                    ((1U << HT_GROUP_WIDTH) - 1);
+    for (; full != 0; full &= full - 1) {
+      visit(&table->items[group + ht_ctz(full)], context);
+    }
+  }
+}
+
+/*
+ * Zjistí stav tabulky do *stats. Pro každý prvek se projde cesta hledání
+ * jeho klíče až k jeho skupině; histogram tedy ukazuje, kolik skupin
+ * prohlédne hledání přítomných klíčů.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(ht_stats_t));
+  if (table == NULL) {
+    return;
+  }
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->count = table->count;
+  stats->size = table->size;
+  stats->load_factor = ht_load_factor(table);
+  int group_mask = table->size / HT_GROUP_WIDTH - 1;
+  for (int i = 0; table->ctrl != NULL && i < table->size; i++) {
+    if (table->ctrl[i] < 0) {
+      continue;
+    }
+    int group = ht_first_group(table->items[i].hash, group_mask);
+    int step = 0;
+    while (group != i / HT_GROUP_WIDTH) {
+      group = (group + ++step) & group_mask;
+    }
+    stats->histogram[step < HT_STATS_BINS ? step : HT_STATS_BINS - 1]++;
+    if (step + 1 > stats->max_chain) {
+      stats->max_chain = step + 1;
+    }
+  }
+}
@@ -0,0 +1,49 @@
+/*
+ * Typy tabuľky s otvoreným adresovaním a riadiacimi bytmi (ht_swiss.c).
+ * Súbor sa vkladá z hashtable.h pri preklade s -DHT_BACKEND_SWISS.
+ *
+ * Ku každému políčku tabuľky patrí jeden riadiaci byte: prázdne, zmazané
+ * alebo obsadené so siedmimi bitmi hodnoty rozptyľovacej funkcie kľúča.
+ * Riadiace byty sa prehľadávajú po skupinách HT_GROUP_WIDTH naraz.
+ */
+
+#ifndef IAL_HASHTABLE_HT_SWISS_H
+#define IAL_HASHTABLE_HT_SWISS_H
+
+#define HT_BACKEND_NAME "swiss"
+
+// Počet riadiacich bytov porovnávaných naraz jednou inštrukciou SSE2
+#define HT_GROUP_WIDTH 16
+
+/*
+ * Hranice faktoru naplnenia. Do hornej hranice sa počítajú aj zmazané
+ * políčka, pretože rovnako predlžujú hľadanie.
+ */
+#define HT_MAX_LOAD_FACTOR 0.875
+#define HT_MIN_LOAD_FACTOR 0.125
+
+// Prvok tabuľky
+typedef struct ht_item {
+  char *key;           // kľúč prvku
+  float value;         // hodnota prvku
+  uint32_t key_length; // dĺžka kľúča bez ukončovacej nuly
+  uint64_t hash;       // neskrátená hodnota rozptyľovacej funkcie kľúča
+} ht_item_t;
+
+// Tabuľka s otvoreným adresovaním
+typedef struct ht_table {
+  int8_t *ctrl;     // riadiace byty políčok, NULL pred prvým vložením
+  ht_item_t *items; // políčka tabuľky
+  int size;         // počet políčok, mocnina dvoch aspoň HT_GROUP_WIDTH
+  int count;        // počet prvkov v tabuľke
+  int deleted;      // počet políčok označených ako zmazané
+  int min_size;     // počiatočná a zároveň najmenšia veľkosť tabuľky
+  int grow_at;      // hranica pre count + deleted, pri ktorej sa tabuľka zväčší
+  int shrink_at;    // počet prvkov, pri ktorom sa tabuľka zmenší
+  uint64_t seed;    // semienko rozptyľovacej funkcie tejto tabuľky
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá volaní
+#endif
+} ht_table_t;
+
+#endif
@@ -0,0 +1,572 @@
+/*
+ * Tabulka s rozptýlenými položkami — seznamy synonym po uzlech
+ *
+ * Alternativní implementace funkcí ht_* ze souboru hashtable.h, která se
+ * použije při překladu s -DHT_BACKEND_UNROLLED. Synonyma se řetězí jako
+ * v hashtable.c, uzel seznamu však nese až HT_NODE_SLOTS prvků a první uzel
+ * každého seznamu leží přímo v poli. Jednobytové značky prvků uzlu tvoří
+ * jedno slovo, které se s hledanou značkou porovná naráz, po bytech uvnitř
+ * 64bitového slova. Klíč se porovnává jen u prvku se shodnou značkou
+ * a shodnou horní polovinou hodnoty rozptylovací funkce. Průchod seznamem
+ * k prvků tak místo k výpadků vyrovnávací paměti stojí zhruba
+ * k / HT_NODE_SLOTS uzlů.
+ *
+ * Všechny uzly seznamu kromě posledního jsou plné: nový prvek se uloží do
+ * posledního uzlu a teprve plný poslední uzel dostane následníka. Na místo
+ * smazaného prvku se přesune poslední prvek seznamu a vyprázdněný poslední
+ * uzel se uvolní.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Zvýší počítadlo counter tabulky o n; bez HT_STATS se nepřeloží nic
+#ifdef HT_STATS
+#define HT_COUNT(table, counter, n) ((table)->counters.counter += (n))
+#else
+#define HT_COUNT(table, counter, n) ((void)0)
+#endif
+
+// Jednička v každém bytu slova a nejvyšší bit každého bytu slova
+#define HT_TAG_ONES 0x0101010101010101ULL
+#define HT_TAG_HIGHS 0x8080808080808080ULL
+
+// Posun bytu s počtem prvků uzlu ve slově tags
+#define HT_FILL_SHIFT 56
+
+// Největší velikost pole, pro kterou se hranice naplnění vejdou do int
+#define HT_MAX_ROWS (INT_MAX / 8)
+
+static inline int ht_ctz64(uint64_t word) {
+#ifdef __GNUC__
+  return __builtin_ctzll(word);
+#else
+  int i = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+/*
+ * Index řádku pole velikosti size pro horní polovinu high hodnoty
+ * rozptylovací funkce, stejně jako v hashtable.c.
+ */
+static inline int ht_index(uint32_t high, int size) {
+  return (int)(((uint64_t)high * (uint64_t)size) >> 32);
+}
+
+/*
+ * Značka prvku: dolních 7 bitů horní poloviny hodnoty rozptylovací funkce
+ * (na řádek mají vliv jen u polí nad 2^25 řádků) s nastaveným nejvyšším
+ * bitem, takže se nikdy nerovná nule volného políčka.
+ */
+static inline uint64_t ht_tag(uint32_t high) { return (high & 0x7F) | 0x80; }
+
+static inline int ht_node_count(const ht_node_t *node) {
+  return (int)(node->tags >> HT_FILL_SHIFT);
+}
+
+/*
+ * Slovo, které má nastavený nejvyšší bit bytu i, pokud je značka v bytu i
+ * slova tags rovna tag. Volná políčka ani byte s počtem prvků se značce
+ * nerovnají nikdy, protože jejich nejvyšší bit je nulový. Přenos při
+ * odčítání může navíc označit byte nad shodným bytem, kandidáty proto
+ * volající ověří.
+ */
+static inline uint64_t ht_match(uint64_t tags, uint64_t tag) {
+  uint64_t diff = tags ^ (tag * HT_TAG_ONES);
+  return (diff - HT_TAG_ONES) & ~diff & HT_TAG_HIGHS;
+}
+
+// Uloží kopii prvku item do políčka slot uzlu node i s jeho značkou
+static inline void ht_node_set(ht_node_t *node, int slot,
+                               const ht_item_t *item) {
+  node->slots[slot] = *item;
+  node->tags = (node->tags & ~(0xFFULL << (8 * slot))) |
+               ht_tag(item->hash) << (8 * slot);
+}
+
+/*
+ * Připojí kopii prvku item na konec seznamu synonym, který začíná uzlem
+ * row. Vrací uložený prvek, nebo NULL, pokud se nepodařilo alokovat nový
+ * uzel.
+ */
+static ht_item_t *ht_append(ht_node_t *row, const ht_item_t *item) {
+  ht_node_t *node = row;
+  while (node->next != NULL) {
+    node = node->next;
+  }
+  int slot = ht_node_count(node);
+  if (slot == HT_NODE_SLOTS) {
+    ht_node_t *next = aligned_alloc(HT_CACHE_LINE, sizeof(ht_node_t));
+    if (next == NULL) {
+      return NULL;
+    }
+    next->tags = 0;
+    next->next = NULL;
+    node->next = next;
+    node = next;
+    slot = 0;
+  }
+  ht_node_set(node, slot, item);
+  node->tags += 1ULL << HT_FILL_SHIFT;
+  return &node->slots[slot];
+}
+
+/*
+ * Alokuje pole size prázdných řádků. Vrací NULL, pokud se nepodařilo
+ * alokovat paměť.
+ */
+static ht_node_t *ht_alloc_rows(int size) {
+  size_t bytes = (size_t)size * sizeof(ht_node_t);
+  ht_node_t *rows = aligned_alloc(HT_CACHE_LINE, bytes);
+  if (rows != NULL) {
+    memset(rows, 0, bytes);
+  }
+  return rows;
+}
+
+// Uvolní všechny uzly seznamů v poli rows kromě prvních, které leží v poli
+static void ht_free_nodes(ht_node_t *rows, int size) {
+  for (int i = 0; rows != NULL && i < size; i++) {
+    ht_node_t *node = rows[i].next;
+    while (node != NULL) {
+      ht_node_t *next = node->next;
+      free(node);
+      node = next;
+    }
+  }
+}
+
+/*
+ * Nastaví velikost tabulky a přepočítá hranice pro změnu velikosti.
+ * Tabulka nikdy neklesne pod svou počáteční velikost.
+ */
+static void ht_set_size(ht_table_t *table, int size) {
+  table->size = size;
+  table->grow_at = size * HT_MAX_LOAD_FACTOR;
+  table->shrink_at = size > table->min_size ? size * HT_MIN_LOAD_FACTOR : 0;
+}
+
+/*
+ * Přesune všechny prvky do nového pole velikosti size. Řádek prvku se určí
+ * z jeho uložené horní poloviny hodnoty rozptylovací funkce, klíče se tedy
+ * znovu nezpracovávají. Pokud se nepodaří alokovat paměť, vrací false
+ * a tabulka zůstává beze změny.
+ */
+static bool ht_rehash(ht_table_t *table, int size) {
+  ht_node_t *rows = ht_alloc_rows(size);
+  bool placed = rows != NULL;
+  for (int i = 0; table->rows != NULL && placed && i < table->size; i++) {
+    for (ht_node_t *node = &table->rows[i]; placed && node != NULL;
+         node = node->next) {
+      for (int slot = 0; placed && slot < ht_node_count(node); slot++) {
+        ht_item_t *item = &node->slots[slot];
+        placed = ht_append(&rows[ht_index(item->hash, size)], item) != NULL;
+      }
+    }
+  }
+  if (!placed) {
+    ht_free_nodes(rows, size);
+    free(rows);
+    return false;
+  }
+  ht_free_nodes(table->rows, table->size);
+  free(table->rows);
+  table->rows = rows;
+  ht_set_size(table, size);
+  return true;
+}
+
+/*
+ * Uzel s prvkem s klíčem key a do *slot jeho políčko, nebo NULL. Uzel se
+ * přeskočí jedním porovnáním slova značek, pokud v něm žádná značka
+ * nesouhlasí.
+ */
+static ht_node_t *ht_probe(ht_table_t *table, char *key, uint64_t hash,
+                           int *slot) {
+  if (table->rows == NULL) {
+    return NULL;
+  }
+  uint32_t high = (uint32_t)(hash >> 32);
+  uint64_t tag = ht_tag(high);
+  for (ht_node_t *node = &table->rows[ht_index(high, table->size)];
+       node != NULL; node = node->next) {
+    HT_COUNT(table, probes, 1);
+    for (uint64_t match = ht_match(node->tags, tag); match != 0;
+         match &= match - 1) {
+      int i = ht_ctz64(match) / 8;
+      if (node->slots[i].hash == high && strcmp(node->slots[i].key, key) == 0) {
+        *slot = i;
+        return node;
+      }
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Hledání klíče funkcí ht_probe započtené do počítadel tabulky.
+ */
+static ht_node_t *ht_find(ht_table_t *table, char *key, uint64_t hash,
+                          int *slot) {
+  ht_node_t *node = ht_probe(table, key, hash, slot);
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, node != NULL);
+  HT_COUNT(table, misses, node == NULL);
+  return node;
+}
+
+// Nalezený prvek s klíčem key, nebo NULL
+static ht_item_t *ht_find_item(ht_table_t *table, char *key, uint64_t hash) {
+  int slot;
+  ht_node_t *node = ht_find(table, key, hash, &slot);
+  return node != NULL ? &node->slots[slot] : NULL;
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ *
+ * Počáteční velikost tabulky je HT_DEFAULT_SIZE řádků. Pole se alokuje až
+ * při prvním vložení prvku.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_size(table, HT_DEFAULT_SIZE);
+}
+
+/*
+ * Inicializace tabulky se zadanou počáteční velikostí v řádcích. Nekladná
+ * velikost znamená HT_DEFAULT_SIZE.
+ */
+void ht_init_size(ht_table_t *table, int size) {
+  if (table != NULL) {
+    size = size > 0 ? size : HT_DEFAULT_SIZE;
+    table->min_size = size < HT_MAX_ROWS ? size : HT_MAX_ROWS;
+    table->seed = ht_random_seed();
+    table->rows = NULL;
+    table->count = 0;
+    ht_set_size(table, table->min_size);
+#ifdef HT_STATS
+    table->counters = (ht_counters_t){0};
+#endif
+  }
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  return ht_find_item(table, key, hash);
+}
+
+/*
+ * Vyhledání více klíčů najednou.
+ *
+ * Do results[i] zapíše prvek s klíčem keys[i], nebo NULL. Klíče se
+ * zpracovávají po HT_BATCH_WINDOW: nejprve se pro všechny spočte hodnota
+ * rozptylovací funkce a vyžádá se načtení obou řádků vyrovnávací paměti
+ * prvního uzlu jejich seznamu, teprve pak se klíče hledají.
+ */
+void ht_search_batch(ht_table_t *table, char *keys[], int count,
+                     ht_item_t *results[]) {
+  uint64_t hashes[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    char **window = keys + start;
+    if (table == NULL || table->rows == NULL) {
+      for (int i = 0; i < n; i++) {
+        results[start + i] = NULL;
+      }
+      continue;
+    }
+    for (int i = 0; i < n; i++) {
+      if (window[i] != NULL) {
+        uint32_t key_length;
+        hashes[i] = ht_hash(window[i], table->seed, &key_length);
+        ht_node_t *row =
+            &table->rows[ht_index((uint32_t)(hashes[i] >> 32), table->size)];
+        HT_PREFETCH(row);
+        HT_PREFETCH((char *)row + HT_CACHE_LINE);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      results[start + i] = window[i] != NULL
+                               ? ht_find_item(table, window[i], hashes[i])
+                               : NULL;
+    }
+  }
+}
+
+/*
+ * Získání hodnot více klíčů najednou.
+ *
+ * Do values[i] zapíše ukazatel na hodnotu klíče keys[i], nebo NULL, pokud
+ * klíč v tabulce není. Klíče vyhledá funkcí ht_search_batch.
+ */
+void ht_get_batch(ht_table_t *table, char *keys[], int count,
+                  float *values[]) {
+  ht_item_t *items[HT_BATCH_WINDOW];
+  for (int start = 0; start < count; start += HT_BATCH_WINDOW) {
+    int n = count - start < HT_BATCH_WINDOW ? count - start : HT_BATCH_WINDOW;
+    ht_search_batch(table, keys + start, n, items);
+    for (int i = 0; i < n; i++) {
+      values[start + i] = items[i] != NULL ? &items[i]->value : NULL;
+    }
+  }
+}
+
+/*
+ * Uloží nový prvek s klíčem, o kterém volající ví, že v tabulce není.
+ * Pokud počet prvků dosáhl hranice naplnění, tabulka se předtím zvětší
+ * na dvojnásobek; když se to nepodaří, prvek se uloží do dosavadního pole.
+ * Vrací nový prvek, nebo NULL, pokud se nepodařilo alokovat paměť.
+ */
+static ht_item_t *ht_add(ht_table_t *table, char *key, uint64_t hash,
+                         float value) {
+  if (table->rows == NULL && !ht_rehash(table, table->size)) {
+    return NULL;
+  }
+  if (table->count >= table->grow_at && table->size <= HT_MAX_ROWS / 2) {
+    ht_rehash(table, 2 * table->size);
+  }
+  ht_item_t item = {
+      .key = key, .value = value, .hash = (uint32_t)(hash >> 32)};
+  ht_item_t *slot =
+      ht_append(&table->rows[ht_index(item.hash, table->size)], &item);
+  if (slot != NULL) {
+    table->count++;
+    HT_COUNT(table, inserts, 1);
+  }
+  return slot;
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahradí jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t *item = ht_find_item(table, key, hash);
+  if (item != NULL) {
+    item->value = value;
+  } else {
+    ht_add(table, key, hash, value);
+  }
+}
+
+/*
+ * Vložení mnoha prvků najednou.
+ *
+ * Vloží count dvojic items[i].key, items[i].value; pro stejné klíče platí
+ * hodnota poslední dvojice. Tabulka se předem jednou zvětší tak, aby se
+ * všechny dvojice vešly bez další změny velikosti, viz ht_swiss.c.
+ */
+void ht_insert_bulk(ht_table_t *table, const ht_item_t items[], int count) {
+  if (table == NULL || items == NULL || count <= 0) {
+    return;
+  }
+  double needed = (table->count + (double)count) / HT_MAX_LOAD_FACTOR + 1;
+  if (needed > table->size && needed <= HT_MAX_ROWS) {
+    ht_rehash(table, (int)needed);
+  }
+  for (int i = 0; i < count; i++) {
+    ht_insert(table, items[i].key, items[i].value);
+  }
+}
+
+/*
+ * Vyhledání prvku, případně jeho vložení s hodnotou 0, jedinou operací.
+ * Viz ht_upsert v hashtable.c.
+ */
+float *ht_upsert(ht_table_t *table, char *key, bool *created) {
+  if (created != NULL) {
+    *created = false;
+  }
+  if (table == NULL || key == NULL) {
+    return NULL;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  ht_item_t *item = ht_find_item(table, key, hash);
+  if (item != NULL) {
+    return &item->value;
+  }
+  item = ht_add(table, key, hash, 0);
+  if (item == NULL) {
+    return NULL;
+  }
+  if (created != NULL) {
+    *created = true;
+  }
+  return &item->value;
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *element = ht_search(table, key);
+  return element != NULL ? &element->value : NULL;
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Na místo smazaného prvku se přesune poslední prvek jeho seznamu synonym,
+ * takže všechny uzly kromě posledního zůstanou plné. Vyprázdněný poslední
+ * uzel se uvolní, první uzel v poli zůstává. Pokud prvek neexistuje, funkce
+ * nedělá nic.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  if (table == NULL || key == NULL) {
+    return;
+  }
+  uint32_t key_length;
+  uint64_t hash = ht_hash(key, table->seed, &key_length);
+  int slot;
+  ht_node_t *node = ht_find(table, key, hash, &slot);
+  if (node == NULL) {
+    return;
+  }
+  ht_node_t *previous = NULL;
+  ht_node_t *last =
+      &table->rows[ht_index(node->slots[slot].hash, table->size)];
+  while (last->next != NULL) {
+    previous = last;
+    last = last->next;
+  }
+  int last_slot = ht_node_count(last) - 1;
+  ht_node_set(node, slot, &last->slots[last_slot]);
+  last->tags = (last->tags & ~(0xFFULL << (8 * last_slot))) -
+               (1ULL << HT_FILL_SHIFT);
+  if (last_slot == 0 && previous != NULL) {
+    previous->next = NULL;
+    free(last);
+  }
+  table->count--;
+  HT_COUNT(table, deletes, 1);
+
+  if (table->count < table->shrink_at) {
+    int size = table->size / 2 > table->min_size ? table->size / 2
+                                                 : table->min_size;
+    ht_rehash(table, size);
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Funkce uvolní pole i všechny další uzly a uvede tabulku do stavu po
+ * inicializaci.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  ht_free_nodes(table->rows, table->size);
+  free(table->rows);
+  table->rows = NULL;
+  table->count = 0;
+  ht_set_size(table, table->min_size);
+}
+
+/*
+ * Vyprázdnění tabulky pro další použití.
+ *
+ * Pole počáteční velikosti ponechá, uvolní jen další uzly seznamů
+ * a vyprázdní první uzly; tabulku jiné velikosti uvolní jako ht_delete_all.
+ */
+void ht_clear(ht_table_t *table) {
+  if (table == NULL) {
+    return;
+  }
+  if (table->rows == NULL || table->size != table->min_size) {
+    ht_delete_all(table);
+    return;
+  }
+  ht_free_nodes(table->rows, table->size);
+  memset(table->rows, 0, (size_t)table->size * sizeof(ht_node_t));
+  table->count = 0;
+}
+
+/*
+ * Faktor naplnění tabulky, tedy průměrný počet prvků na řádek pole.
+ */
+float ht_load_factor(ht_table_t *table) {
+  if (table == NULL || table->size == 0) {
+    return 0;
+  }
+  return (float)table->count / table->size;
+}
+
+/*
+ * Zavolá visit(item, context) pro každý prvek tabulky. Funkce visit nesmí
+ * tabulku měnit.
+ */
+void ht_foreach(ht_table_t *table, ht_visit_t visit, void *context) {
+  if (table == NULL || table->rows == NULL) {
+    return;
+  }
+  for (int i = 0; i < table->size; i++) {
+    for (ht_node_t *node = &table->rows[i]; node != NULL; node = node->next) {
+      for (int slot = 0; slot < ht_node_count(node); slot++) {
+        visit(&node->slots[slot], context);
+      }
+    }
+  }
+}
+
+/*
+ * Zjistí stav tabulky do *stats. Histogram počítá řádky podle počtu jejich
+ * prvků jako v hashtable.c; max_chain je největší počet uzlů jednoho
+ * seznamu synonym.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  if (stats == NULL) {
+    return;
+  }
+  memset(stats, 0, sizeof(ht_stats_t));
+  if (table == NULL) {
+    return;
+  }
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->count = table->count;
+  stats->size = table->size;
+  stats->load_factor = ht_load_factor(table);
+  for (int i = 0; table->rows != NULL && i < table->size; i++) {
+    int items = 0;
+    int nodes = 0;
+    for (ht_node_t *node = &table->rows[i]; node != NULL; node = node->next) {
+      items += ht_node_count(node);
+      nodes++;
+    }
+    stats->histogram[items < HT_STATS_BINS ? items : HT_STATS_BINS - 1]++;
+    if (items > 0 && nodes > stats->max_chain) {
+      stats->max_chain = nodes;
+    }
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Typy tabuľky so zoznamami synonym po uzloch s niekoľkými prvkami
+ * (ht_unrolled.c). Súbor sa vkladá z hashtable.h pri preklade
+ * s -DHT_BACKEND_UNROLLED.
+ *
+ * Riadok poľa je priamo prvý uzol zoznamu synonym. Uzol drží až
+ * HT_NODE_SLOTS prvkov a jednobytové značky ich kľúčov v jednom slove,
+ * takže hľadanie odmietne celý uzol jedným porovnaním značiek a kľúč číta
+ * len pri zhode značky. Ďalší uzol sa k zoznamu pripojí, až keď sú všetky
+ * predchádzajúce plné.
+ */
+
+#ifndef IAL_HASHTABLE_HT_UNROLLED_H
+#define IAL_HASHTABLE_HT_UNROLLED_H
+
+#define HT_UNROLLED
+#define HT_BACKEND_NAME "unrolled"
+
+/*
+ * Hranice faktoru naplnenia (priemerný počet prvkov na riadok). Pri hornej
+ * hranici pretečie prvý uzol len asi v každom dvadsiatom riadku.
+ */
+#define HT_MAX_LOAD_FACTOR 4.0
+#define HT_MIN_LOAD_FACTOR 0.5
+
+// Počet prvkov v jednom uzle; uzol so značkami zaberá dva riadky pamäte
+#define HT_NODE_SLOTS 7
+
+// Veľkosť riadku vyrovnávacej pamäte, na ktorú sú zarovnané uzly
+#define HT_CACHE_LINE 64
+
+/*
+ * Prvok tabuľky. Horná polovica hodnoty rozptyľovacej funkcie určuje riadok
+ * aj značku kľúča, zmena veľkosti teda kľúče znova nespracúva.
+ */
+typedef struct ht_item {
+  char *key;     // kľúč prvku
+  float value;   // hodnota prvku
+  uint32_t hash; // horných 32 bitov hodnoty rozptyľovacej funkcie kľúča
+} ht_item_t;
+
+/*
+ * Uzol zoznamu synonym. Obsadené sú políčka 0 až n - 1, kde n je počet
+ * prvkov uzla uložený v najvyššom byte slova tags; byte i pod ním je
+ * značka prvku v políčku i, pre voľné políčko 0.
+ */
+typedef struct ht_node {
+  _Alignas(HT_CACHE_LINE) uint64_t tags; // značky prvkov a ich počet
+  struct ht_node *next;                  // ďalší uzol zoznamu, alebo NULL
+  ht_item_t slots[HT_NODE_SLOTS];        // prvky uzla
+} ht_node_t;
+
+// Tabuľka so zoznamami synonym po uzloch
+typedef struct ht_table {
+  ht_node_t *rows; // prvé uzly zoznamov synonym, NULL pred prvým vložením
+  int size;        // počet riadkov poľa rows
+  int count;       // počet prvkov v tabuľke
+  int min_size;    // počiatočná a zároveň najmenšia veľkosť tabuľky
+  int grow_at;     // počet prvkov, pri ktorom sa tabuľka zväčší
+  int shrink_at;   // počet prvkov, pri ktorom sa tabuľka zmenší
+  uint64_t seed;   // semienko rozptyľovacej funkcie tejto tabuľky
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá volaní
+#endif
+} ht_table_t;
+
+#endif
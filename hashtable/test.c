@@ -1,7 +1,14 @@
 #include "hashtable.h"
+#include "ht_frozen.h"
+#include "ht_generic.h"
+#include "ht_sharded.h"
 #include "test_util.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef HT_CONCURRENT
+#include <pthread.h>
+#endif
 
 #define INSERT_TEST_DATA(TABLE)                                                \
   ht_insert_many(TABLE, TEST_DATA, sizeof(TEST_DATA) / sizeof(TEST_DATA[0]));
@@ -13,11 +20,31 @@ const ht_item_t TEST_DATA[15] = {
     {"USD Coin", 0.86},    {"Uniswap", 21.68},    {"Terra", 30.67},
     {"Litecoin", 156.87},  {"Avalanche", 47.03},  {"Chainlink", 21.90}};
 
+#define TEST_HT_SIZE 13
+
+#define FROZEN_TEST_FILE "test_frozen.bin"
+
+#define GROW_KEY_COUNT 40
+char GROW_KEYS[GROW_KEY_COUNT][8];
+
+void insert_grow_keys(ht_table_t *table) {
+  for (int i = 0; i < GROW_KEY_COUNT; i++) {
+    ht_insert(table, GROW_KEYS[i], i);
+  }
+}
+
+void count_item(ht_item_t *item, void *context) {
+  (void)item;
+  (*(int *)context)++;
+}
+
 void init_test() {
   printf("Hash Table - testing script\n");
   printf("---------------------------\n");
-  HT_SIZE = 13;
-  printf("\nSetting HT_SIZE to prime number (%i)\n", HT_SIZE);
+  printf("\nInitializing test tables to size (%i)\n", TEST_HT_SIZE);
+  for (int i = 0; i < GROW_KEY_COUNT; i++) {
+    sprintf(GROW_KEYS[i], "key%02i", i);
+  }
   printf("\n");
 }
 
@@ -25,71 +52,383 @@ TEST(test_table_init, "Initialize the table")
 ht_init(test_table);
 ENDTEST
 
+TEST(test_table_init_size, "Initialize tables of different sizes")
+ht_table_t small_table;
+ht_init_size(&small_table, 4);
+ht_init_size(test_table, TEST_HT_SIZE);
+ht_insert(&small_table, "Bitcoin", 53247.71);
+INSERT_TEST_DATA(test_table)
+ht_print_table(&small_table);
+ht_delete_all(&small_table);
+ENDTEST
+
 TEST(test_search_nonexist, "Search for a non-existing item")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 ht_search(test_table, "Ethereum");
 ENDTEST
 
 TEST(test_insert_simple, "Insert a new item")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 ht_insert(test_table, "Ethereum", 3208.67);
 ENDTEST
 
 TEST(test_search_exist, "Search for an existing item")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 ht_insert(test_table, "Ethereum", 3208.67);
 ht_search(test_table, "Ethereum");
 ENDTEST
 
 TEST(test_insert_many, "Insert many new items")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 INSERT_TEST_DATA(test_table)
 ENDTEST
 
+TEST(test_insert_bulk, "Insert many items at once, with a duplicate key")
+ht_item_t items[sizeof(TEST_DATA) / sizeof(TEST_DATA[0]) + 1];
+int count = sizeof(TEST_DATA) / sizeof(TEST_DATA[0]);
+memcpy(items, TEST_DATA, sizeof(TEST_DATA));
+items[count].key = "Ethereum";
+items[count].value = 12.34;
+ht_init_size(test_table, TEST_HT_SIZE);
+ht_insert_bulk(test_table, items, count + 1);
+ht_print_item_value(ht_get(test_table, "Ethereum"));
+ENDTEST
+
 TEST(test_search_collision, "Search for an item with colliding hash")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 INSERT_TEST_DATA(test_table)
 ht_search(test_table, "Terra");
 ENDTEST
 
 TEST(test_insert_update, "Update an item")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 INSERT_TEST_DATA(test_table)
 ht_insert(test_table, "Ethereum", 12.34);
 ENDTEST
 
 TEST(test_get, "Get an item's value")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 INSERT_TEST_DATA(test_table)
 ht_get(test_table, "Ethereum");
 ENDTEST
 
+TEST(test_get_batch, "Get values of several items at once")
+ht_init_size(test_table, TEST_HT_SIZE);
+INSERT_TEST_DATA(test_table)
+char *keys[] = {"Ethereum", "Dogecoin", "Monero", "Terra"};
+float *values[4];
+ht_get_batch(test_table, keys, 4, values);
+for (int i = 0; i < 4; i++) {
+  ht_print_item_value(values[i]);
+}
+ENDTEST
+
+TEST(test_upsert, "Count keys with upsert")
+ht_init_size(test_table, TEST_HT_SIZE);
+char *words[] = {"XRP", "Terra", "XRP", "Solana", "XRP", "Terra"};
+for (int i = 0; i < 6; i++) {
+  (*ht_upsert(test_table, words[i], NULL))++;
+}
+ht_print_item_value(ht_get(test_table, "XRP"));
+ENDTEST
+
 TEST(test_delete, "Delete an item")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 INSERT_TEST_DATA(test_table)
 ht_delete(test_table, "Terra");
 ENDTEST
 
 TEST(test_delete_all, "Delete all the items")
-ht_init(test_table);
+ht_init_size(test_table, TEST_HT_SIZE);
 INSERT_TEST_DATA(test_table)
 ht_delete_all(test_table);
 ENDTEST
 
+TEST(test_clear, "Clear the table and reuse it")
+ht_init_size(test_table, TEST_HT_SIZE);
+INSERT_TEST_DATA(test_table)
+ht_clear(test_table);
+ht_insert(test_table, "Bitcoin", 53247.71);
+ht_print_item_value(ht_get(test_table, "Ethereum"));
+ENDTEST
+
+TEST(test_foreach, "Visit every item of a grown table")
+int visited = 0;
+ht_init_size(test_table, TEST_HT_SIZE);
+insert_grow_keys(test_table);
+ht_foreach(test_table, count_item, &visited);
+printf("%i\n", visited);
+ENDTEST
+
+TEST(test_stats, "Report chain lengths and load factor")
+ht_init_size(test_table, TEST_HT_SIZE);
+INSERT_TEST_DATA(test_table)
+ht_search(test_table, "Bitcoin");
+ht_search(test_table, "Monero");
+ht_delete(test_table, "Tether");
+ht_stats_print(test_table, stdout);
+ENDTEST
+
+TEST(test_freeze, "Freeze the table, save it and load it back")
+ht_frozen_t frozen;
+ht_frozen_t loaded;
+int matched = 0;
+ht_init_size(test_table, TEST_HT_SIZE);
+INSERT_TEST_DATA(test_table)
+ht_freeze(test_table, &frozen);
+ht_delete(test_table, "Bitcoin");
+ht_print_item_value(ht_frozen_get(&frozen, "Bitcoin"));
+ht_print_item_value(ht_frozen_get(&frozen, "Monero"));
+ht_frozen_save(&frozen, FROZEN_TEST_FILE);
+ht_frozen_load(&loaded, FROZEN_TEST_FILE);
+remove(FROZEN_TEST_FILE);
+for (int i = 0; i < (int)(sizeof(TEST_DATA) / sizeof(TEST_DATA[0])); i++) {
+  float *value = ht_frozen_get(&loaded, TEST_DATA[i].key);
+  matched += value != NULL && *value == TEST_DATA[i].value;
+}
+printf("%i\n", matched);
+ht_frozen_free(&frozen);
+ht_frozen_free(&loaded);
+ENDTEST
+
+TEST(test_generic, "Integer and string keys in generated tables")
+ht_u64_t ids;
+ht_str_t names;
+ht_init(test_table);
+ht_u64_init_size(&ids, 4);
+ht_str_init(&names);
+for (uint64_t id = 0; id < GROW_KEY_COUNT; id++) {
+  ht_u64_insert(&ids, id * 1000003, id / 4.0);
+}
+ht_u64_delete(&ids, 1000003);
+for (int i = 0; i < (int)(sizeof(TEST_DATA) / sizeof(TEST_DATA[0])); i++) {
+  ht_str_insert(&names, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+(*ht_str_upsert(&names, "Monero", NULL))++;
+printf("%i %i\n", ids.count, names.count);
+printf("%.2f\n", *ht_u64_get(&ids, 39 * 1000003));
+printf("%s\n", ht_u64_get(&ids, 1000003) == NULL ? "NULL" : "found");
+printf("%.2f\n", *ht_str_get(&names, "Bitcoin"));
+printf("%.2f\n", *ht_str_get(&names, "Monero"));
+ht_u64_delete_all(&ids);
+ht_str_delete_all(&names);
+ENDTEST
+
+TEST(test_sharded, "Insert, read and delete in batches across shards")
+ht_sharded_t sharded;
+char *keys[] = {"Bitcoin", "Ethereum", "Monero", "Tether"};
+float values[4];
+bool found[4];
+ht_init(test_table);
+ht_sharded_init(&sharded, 4, 0);
+ht_sharded_insert_batch(&sharded, TEST_DATA,
+                        sizeof(TEST_DATA) / sizeof(TEST_DATA[0]));
+ht_sharded_insert(&sharded, "Bitcoin", 1);
+ht_sharded_delete_batch(&sharded, keys + 3, 1);
+ht_sharded_read_batch(&sharded, keys, 4, values, found);
+for (int i = 0; i < 4; i++) {
+  ht_print_item_value(found[i] ? &values[i] : NULL);
+}
+printf("%i\n", ht_sharded_count(&sharded));
+ht_sharded_free(&sharded);
+ENDTEST
+
+TEST(test_grow, "Grow the table past its load factor")
+ht_init_size(test_table, TEST_HT_SIZE);
+insert_grow_keys(test_table);
+ht_print_item_value(ht_get(test_table, "key00"));
+ht_print_item_value(ht_get(test_table, "key39"));
+ENDTEST
+
+TEST(test_shrink, "Shrink the table after deleting most items")
+ht_init_size(test_table, TEST_HT_SIZE);
+insert_grow_keys(test_table);
+for (int i = 0; i < GROW_KEY_COUNT - 2; i++) {
+  ht_delete(test_table, GROW_KEYS[i]);
+}
+ht_print_item_value(ht_get(test_table, "key39"));
+ENDTEST
+
+#ifdef HT_CHAINED
+TEST(test_own_keys, "Insert copies of short and long keys")
+char key[64];
+ht_init_flags(test_table, TEST_HT_SIZE, HT_OWN_KEYS);
+strcpy(key, "Bitcoin");
+ht_insert(test_table, key, 53247.71);
+strcpy(key, "A rather long key that does not fit into the item");
+ht_insert(test_table, key, 1.0);
+strcpy(key, "overwritten");
+ht_print_item_value(ht_get(test_table, "Bitcoin"));
+ht_print_item_value(ht_get(test_table, key));
+ENDTEST
+
+TEST(test_move_to_front, "Move found items to the front of their chains")
+ht_init_flags(test_table, TEST_HT_SIZE, HT_MOVE_TO_FRONT);
+INSERT_TEST_DATA(test_table)
+ht_print_item_value(ht_get(test_table, "Cardano"));
+ht_print_item_value(ht_get(test_table, "Tether"));
+ENDTEST
+
+TEST(test_bloom, "Filter missing keys, then rebuild after many deletes")
+ht_init_flags(test_table, TEST_HT_SIZE, HT_BLOOM);
+insert_grow_keys(test_table);
+ht_print_item_value(ht_get(test_table, "key39"));
+ht_print_item_value(ht_get(test_table, "key40"));
+for (int i = 0; i < GROW_KEY_COUNT / 2; i++) {
+  ht_delete(test_table, GROW_KEYS[2 * i]);
+  ht_insert(test_table, GROW_KEYS[2 * i], -i);
+  ht_delete(test_table, GROW_KEYS[2 * i]);
+}
+ht_print_item_value(ht_get(test_table, "key00"));
+ht_print_item_value(ht_get(test_table, "key01"));
+ENDTEST
+
+TEST(test_cache, "Evict unused items once the cache is full")
+ht_init_cache(test_table, 4, 0, 0);
+for (int i = 0; i < (int)(sizeof(TEST_DATA) / sizeof(TEST_DATA[0])); i++) {
+  ht_get(test_table, "Ethereum");
+  ht_insert(test_table, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_print_item_value(ht_get(test_table, "Ethereum"));
+ht_print_item_value(ht_get(test_table, "Bitcoin"));
+printf("%i %llu %llu %llu\n", test_table->count,
+       (unsigned long long)test_table->cache.hits,
+       (unsigned long long)test_table->cache.misses,
+       (unsigned long long)test_table->cache.evictions);
+ENDTEST
+
+float add_values(float value, float other) { return value + other; }
+
+TEST(test_insert_parallel, "Insert, then sum values from several threads")
+int count = sizeof(TEST_DATA) / sizeof(TEST_DATA[0]);
+ht_item_t items[2 * sizeof(TEST_DATA) / sizeof(TEST_DATA[0])];
+memcpy(items, TEST_DATA, sizeof(TEST_DATA));
+memcpy(items + count, TEST_DATA, sizeof(TEST_DATA));
+ht_init_size(test_table, TEST_HT_SIZE);
+ht_insert(test_table, "Ethereum", 1);
+ht_insert_parallel(test_table, items, count, 2, NULL);
+ht_print_item_value(ht_get(test_table, "Ethereum"));
+ht_insert_parallel(test_table, items, 2 * count, 2, add_values);
+ht_print_item_value(ht_get(test_table, "Ethereum"));
+ENDTEST
+#endif
+
+#ifdef HT_CONCURRENT
+#define TEST_THREADS 4
+
+typedef struct test_thread {
+  pthread_t thread;
+  ht_table_t *table;
+  int first; // první klíč z GROW_KEYS, který vlákno vkládá
+} test_thread_t;
+
+void *insert_grow_keys_part(void *arg) {
+  test_thread_t *self = arg;
+  for (int i = self->first; i < GROW_KEY_COUNT; i += TEST_THREADS) {
+    ht_insert(self->table, GROW_KEYS[i], i);
+    float value;
+    if (!ht_read(self->table, GROW_KEYS[i], &value) || value != i) {
+      printf("lost %s\n", GROW_KEYS[i]);
+    }
+    if (i >= GROW_KEY_COUNT - 8) {
+      ht_delete(self->table, GROW_KEYS[i]);
+    }
+  }
+  return NULL;
+}
+
+TEST(test_threads, "Insert, read and delete from several threads")
+test_thread_t threads[TEST_THREADS];
+ht_init_size(test_table, TEST_HT_SIZE);
+for (int i = 0; i < TEST_THREADS; i++) {
+  threads[i].table = test_table;
+  threads[i].first = i;
+  pthread_create(&threads[i].thread, NULL, insert_grow_keys_part, &threads[i]);
+}
+for (int i = 0; i < TEST_THREADS; i++) {
+  pthread_join(threads[i].thread, NULL);
+}
+ht_print_item_value(ht_get(test_table, "key00"));
+ht_print_item_value(ht_get(test_table, "key39"));
+ENDTEST
+
+// Počet kol vkládání a mazání, po kterých už se uvolňují odložená pole
+#define TEST_ROUNDS 100
+
+char *COUNTER_KEYS[TEST_THREADS] = {"counter0", "counter1", "counter2",
+                                    "counter3"};
+
+// Vkládání a mazání klíčů zvětšuje a zmenšuje tabulku pod ukazatelem čítače
+void *upsert_across_resize(void *arg) {
+  test_thread_t *self = arg;
+  float *counter = ht_upsert(self->table, COUNTER_KEYS[self->first], NULL);
+  for (int round = 0; round < TEST_ROUNDS; round++) {
+    for (int i = self->first; i < GROW_KEY_COUNT; i += TEST_THREADS) {
+      ht_insert(self->table, GROW_KEYS[i], i);
+      (*counter)++;
+    }
+    for (int i = self->first; i < GROW_KEY_COUNT; i += TEST_THREADS) {
+      ht_delete(self->table, GROW_KEYS[i]);
+      (*counter)++;
+    }
+  }
+  return NULL;
+}
+
+TEST(test_upsert_threads, "Count through ht_upsert while others resize")
+test_thread_t threads[TEST_THREADS];
+ht_init_size(test_table, TEST_HT_SIZE);
+for (int i = 0; i < TEST_THREADS; i++) {
+  threads[i].table = test_table;
+  threads[i].first = i;
+  pthread_create(&threads[i].thread, NULL, upsert_across_resize, &threads[i]);
+}
+for (int i = 0; i < TEST_THREADS; i++) {
+  pthread_join(threads[i].thread, NULL);
+}
+for (int i = 0; i < TEST_THREADS; i++) {
+  ht_print_item_value(ht_get(test_table, COUNTER_KEYS[i]));
+}
+ENDTEST
+#endif
+
 int main(int argc, char *argv[]) {
   init_uninitialized_item();
   init_test();
 
   test_table_init();
+  test_table_init_size();
   test_search_nonexist();
   test_insert_simple();
   test_search_exist();
   test_insert_many();
+  test_insert_bulk();
   test_search_collision();
   test_insert_update();
   test_get();
+  test_get_batch();
+  test_upsert();
   test_delete();
   test_delete_all();
+  test_clear();
+  test_foreach();
+  test_stats();
+  test_freeze();
+  test_generic();
+  test_sharded();
+  test_grow();
+  test_shrink();
+#ifdef HT_CHAINED
+  test_own_keys();
+  test_move_to_front();
+  test_bloom();
+  test_cache();
+  test_insert_parallel();
+#endif
+#ifdef HT_CONCURRENT
+  test_threads();
+  test_upsert_threads();
+#endif
 
   free(uninitialized_item);
 }
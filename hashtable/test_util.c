@@ -21,15 +21,19 @@ void ht_print_item(ht_item_t *item) {
   }
 }
 
-void ht_print_table(ht_table_t *table) {
-  int max_count = 0;
-  int sum_count = 0;
+#if defined(HT_CHAINED) || defined(HT_CONCURRENT)
+#ifdef HT_CONCURRENT
+typedef _Atomic(ht_item_t *) ht_row_t;
+#else
+typedef ht_item_t *ht_row_t;
+#endif
 
-  printf("------------HASH TABLE--------------\n");
-  for (int i = 0; i < HT_SIZE; i++) {
+static int ht_print_items(ht_row_t *items, int size, int *max_count) {
+  int sum_count = 0;
+  for (int i = 0; i < size; i++) {
     printf("%i: ", i);
     int count = 0;
-    ht_item_t *item = (*table)[i];
+    ht_item_t *item = items[i];
     while (item != NULL) {
       printf("(%s,%.2f)", item->key, item->value);
       if (item != uninitialized_item) {
@@ -38,30 +42,168 @@ void ht_print_table(ht_table_t *table) {
       item = item->next;
     }
     printf("\n");
-    if (count > max_count) {
-      max_count = count;
+    if (count > *max_count) {
+      *max_count = count;
     }
     sum_count += count;
   }
+  return sum_count;
+}
+
+void ht_print_table(ht_table_t *table) {
+  int max_count = 0;
+  int sum_count = 0;
+
+  printf("------------HASH TABLE--------------\n");
+#ifdef HT_CONCURRENT
+  ht_rows_t *rows = table->rows;
+  int size = rows != NULL ? rows->size : table->min_size;
+  if (rows != NULL) {
+    sum_count += ht_print_items(rows->heads, rows->size, &max_count);
+  }
+#else
+  int size = table->size;
+  if (table->items != NULL) {
+    sum_count += ht_print_items(table->items, table->size, &max_count);
+  }
+  if (table->old_items != NULL) {
+    printf("---------RESIZING FROM (%i)----------\n", table->old_size);
+    sum_count += ht_print_items(table->old_items, table->old_size, &max_count);
+  }
+#endif
 
   printf("------------------------------------\n");
   printf("Total items in hash table: %i\n", sum_count);
+  printf("Table size: %i\n", size);
   printf("Maximum hash collisions: %i\n", max_count == 0 ? 0 : max_count - 1);
   printf("------------------------------------\n");
 }
+#elif defined(HT_ROBIN)
+void ht_print_table(ht_table_t *table) {
+  int max_distance = 0;
+  int sum_count = 0;
+
+  printf("------------HASH TABLE--------------\n");
+  for (int i = 0; table->distances != NULL && i < table->size; i++) {
+    if (table->distances[i] != 0) {
+      ht_item_t *item = &table->items[i];
+      printf("%i: (%s,%.2f) +%i\n", i, item->key, item->value,
+             table->distances[i] - 1);
+      if (table->distances[i] - 1 > max_distance) {
+        max_distance = table->distances[i] - 1;
+      }
+      sum_count++;
+    }
+  }
+
+  printf("------------------------------------\n");
+  printf("Total items in hash table: %i\n", sum_count);
+  printf("Table size: %i\n", table->size);
+  printf("Maximum probe distance: %i\n", max_distance);
+  printf("------------------------------------\n");
+}
+#elif defined(HT_CUCKOO)
+void ht_print_table(ht_table_t *table) {
+  int sum_count = 0;
+
+  printf("------------HASH TABLE--------------\n");
+  for (int i = 0; table->buckets != NULL && i < table->bucket_count; i++) {
+    printf("%i: ", i);
+    for (int slot = 0; slot < HT_BUCKET_SLOTS; slot++) {
+      ht_item_t *item = &table->buckets[i].slots[slot];
+      if (item->key != NULL) {
+        printf("(%s,%.2f)", item->key, item->value);
+        sum_count++;
+      }
+    }
+    printf("\n");
+  }
+
+  printf("------------------------------------\n");
+  printf("Total items in hash table: %i\n", sum_count);
+  printf("Table size: %i\n", table->size);
+  printf("------------------------------------\n");
+}
+#elif defined(HT_UNROLLED)
+void ht_print_table(ht_table_t *table) {
+  int max_nodes = 0;
+  int sum_count = 0;
+
+  printf("------------HASH TABLE--------------\n");
+  for (int i = 0; table->rows != NULL && i < table->size; i++) {
+    printf("%i: ", i);
+    int nodes = 0;
+    for (ht_node_t *node = &table->rows[i]; node != NULL; node = node->next) {
+      printf(nodes > 0 ? " | " : "");
+      for (int slot = 0; slot < (int)(node->tags >> 56); slot++) {
+        printf("(%s,%.2f)", node->slots[slot].key, node->slots[slot].value);
+        sum_count++;
+      }
+      nodes++;
+    }
+    printf("\n");
+    if (nodes > max_nodes) {
+      max_nodes = nodes;
+    }
+  }
+
+  printf("------------------------------------\n");
+  printf("Total items in hash table: %i\n", sum_count);
+  printf("Table size: %i\n", table->size);
+  printf("Maximum chain nodes: %i\n", max_nodes);
+  printf("------------------------------------\n");
+}
+#else
+void ht_print_table(ht_table_t *table) {
+  int sum_count = 0;
+
+  printf("------------HASH TABLE--------------\n");
+  for (int i = 0; table->ctrl != NULL && i < table->size; i++) {
+    if (table->ctrl[i] >= 0) {
+      ht_item_t *item = &table->items[i];
+      printf("%i: (%s,%.2f)\n", i, item->key, item->value);
+      sum_count++;
+    }
+  }
+
+  printf("------------------------------------\n");
+  printf("Total items in hash table: %i\n", sum_count);
+  printf("Table size: %i\n", table->size);
+  printf("------------------------------------\n");
+}
+#endif
 
 void init_uninitialized_item() {
   uninitialized_item = (ht_item_t *)malloc(sizeof(ht_item_t));
   uninitialized_item->key = "*UNINITIALIZED*";
   uninitialized_item->value = -1;
+#if defined(HT_CHAINED) || defined(HT_CONCURRENT)
   uninitialized_item->next = NULL;
+#endif
 }
 
 void init_test_table(ht_table_t **table) {
   (*table) = (ht_table_t *)malloc(sizeof(ht_table_t));
-  for (int i = 0; i < MAX_HT_SIZE; i++) {
-    (**table)[i] = uninitialized_item;
-  };
+#ifdef HT_CHAINED
+  (*table)->items = &uninitialized_item;
+  (*table)->size = 1;
+  (*table)->old_items = NULL;
+#elif defined(HT_CONCURRENT)
+  (*table)->rows = NULL;
+  (*table)->min_size = 0;
+#elif defined(HT_ROBIN)
+  (*table)->distances = NULL;
+  (*table)->size = 0;
+#elif defined(HT_CUCKOO)
+  (*table)->buckets = NULL;
+  (*table)->size = 0;
+#elif defined(HT_UNROLLED)
+  (*table)->rows = NULL;
+  (*table)->size = 0;
+#else
+  (*table)->ctrl = NULL;
+  (*table)->size = 0;
+#endif
 }
 
 void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count) {